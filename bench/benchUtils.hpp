@@ -0,0 +1,116 @@
+#pragma once
+
+/*
+    Fixtures shared by the benchmarks: the root positions, the walk of their
+    legal move trees, the samples of positions taken from the trees and the
+    timing of the benchmarked functions.
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "board.hpp"
+#include "moveGenerator.hpp"
+
+// well known positions with captures, promotions, en passant and castling in their trees
+inline const char *const rootPositions[] = {
+    StartFEN,
+    KiwipeteFEN,
+    EnPassantFEN,
+    PromotionFEN,
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+/*
+ *   Call visit(board) in every position of the legal move tree of the board up to the depth,
+ *   the board is the same after the walk
+ */
+template <typename Visit>
+void walkTree(Board &board, int depth, Visit &visit)
+{
+    visit(board);
+
+    if (depth == 0)
+        return;
+
+    MoveList moves;
+    generateLegalMoves(moves, board);
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        board.makeMove(moves.get(i));
+        walkTree(board, depth - 1, visit);
+        board.unmakeMove(moves.get(i));
+    }
+}
+
+// call visit(board) in every position of the trees of all the root positions up to the depth
+template <typename Visit>
+void walkRootPositions(int depth, Visit visit)
+{
+    Board board;
+
+    for (const char *fen : rootPositions)
+    {
+        board.loadFen(fen);
+        walkTree(board, depth, visit);
+    }
+}
+
+/*
+ *   Take one of each sampleStep positions of the trees of the root positions up to the depth,
+ *   the positions taken are kept if filter(board) is true
+ */
+template <typename Filter>
+std::vector<Board> sampleRootPositions(int depth, int sampleStep, Filter filter)
+{
+    std::vector<Board> sample;
+    int nodeCount = 0;
+
+    walkRootPositions(depth, [&](const Board &board)
+                      {
+        if (nodeCount++ % sampleStep == 0 && filter(board))
+            sample.push_back(board); });
+
+    return sample;
+}
+
+inline std::vector<Board> sampleRootPositions(int depth, int sampleStep)
+{
+    return sampleRootPositions(depth, sampleStep, [](const Board &) { return true; });
+}
+
+// print the time and the rate of a benchmark, count items of the unit were processed in elapsedUs
+inline void printBenchmark(const char *name, const char *unit, uint64_t count, int64_t elapsedUs, uint64_t checksum)
+{
+    std::cout << std::left << std::setw(16) << name
+              << "  time " << std::setw(8) << elapsedUs / 1000 << " ms"
+              << "  " << unit << "/second " << std::setw(12) << count * 1000000 / (elapsedUs > 0 ? elapsedUs : 1)
+              << "  checksum " << checksum << std::endl;
+}
+
+/*
+ *   Call function(item) for all the items the given repetitions and print the items per second.
+ *   The values returned by the function are accumulated so the compiler can not remove the work,
+ *   the checksum wraps around
+ */
+template <typename Item, typename Function>
+void runBenchmark(const char *name, const char *unit, const std::vector<Item> &items, int repetitions, Function function)
+{
+    uint64_t checksum = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int repetition = 0; repetition < repetitions; repetition++)
+        for (const Item &item : items)
+            checksum += static_cast<uint64_t>(function(item));
+
+    const auto end = std::chrono::steady_clock::now();
+
+    printBenchmark(name, unit, static_cast<uint64_t>(items.size()) * repetitions,
+                   std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(), checksum);
+}
@@ -0,0 +1,329 @@
+/*
+    Evaluation benchmark
+
+    Walk the legal move tree of a few well known positions and check at every node
+    that the evaluation with the material and piece-square sums updated by the board
+    and the pawn table is equal to the evaluation computed scanning the board.
+    Then evaluate a sample of the positions several times with the incremental
+    evaluation and with the scan, and report the evaluations per second of each
+    one and the hit rate of the pawn table.
+
+    The NNUE evaluation is checked too: the kernels of each instruction set
+    supported by the cpu should give the same results as the scalar ones, and
+    the evaluation with the accumulators updated incrementally along the tree
+    walk should be equal to the evaluation with the accumulators computed from
+    scratch. Then the tree is walked evaluating every node with both methods and
+    the nodes per second are reported. Without a network file a random network
+    with a fixed seed is written to the temporary directory and used.
+
+    Return 1 if any position does not match.
+
+    Usage: eval_bench [repetitions] [network file]
+*/
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "benchUtils.hpp"
+#include "board.hpp"
+#include "evaluation.hpp"
+#include "moveGenerator.hpp"
+#include "nnue.hpp"
+#include "nnueKernels.hpp"
+
+// one of each SAMPLE_STEP positions of the tree is evaluated in the timed runs
+constexpr int SAMPLE_STEP = 256;
+
+/*
+ *   Reference evaluation, scan all the pieces of the board
+ */
+static int scanEvaluate(const Board &board)
+{
+    int mg = 0, eg = 0, phase = 0;
+
+    for (int piece = 0; piece < 12; piece++)
+    {
+        const int type = piece % 6;
+        const Color pieceColor = piece < 6 ? Color::WHITE : Color::BLACK;
+        const int sign = piece < 6 ? 1 : -1;
+        uint64_t bitboard = board.bitBoards[piece];
+
+        while (bitboard)
+        {
+            const int square = std::countr_zero(bitboard);
+            bitboard &= bitboard - 1;
+
+            mg += sign * (materialMg[type] + pstMg[type][pstIndex(pieceColor, square)]);
+            eg += sign * (materialEg[type] + pstEg[type][pstIndex(pieceColor, square)]);
+            phase += gamePhaseValue[type];
+        }
+    }
+
+    PawnEntry pawns;
+    evaluatePawns(board.bitBoards[index(Piece::WPawn)], board.bitBoards[index(Piece::BPawn)], pawns);
+    mg += pawns.mg;
+    eg += pawns.eg;
+
+    phase = phase < MAX_GAME_PHASE ? phase : MAX_GAME_PHASE;
+    const int score = (mg * phase + eg * (MAX_GAME_PHASE - phase)) / MAX_GAME_PHASE;
+
+    return board.sideToMove == Color::WHITE ? score : -score;
+}
+
+/*
+ *   Compare the results of the kernels with the scalar kernels on random data
+ */
+static bool checkKernels(const NnueKernels &kernels)
+{
+    constexpr int SIZE = 2 * NNUE_L1_SIZE;
+    constexpr int OUTPUTS = NNUE_L2_SIZE;
+
+    std::mt19937 random(12345);
+    std::vector<int16_t> input(SIZE), rows(4 * SIZE), accumulators[2];
+    std::vector<uint8_t> activations[2];
+    std::vector<int8_t> weights(OUTPUTS * SIZE);
+    std::vector<int32_t> bias(OUTPUTS), outputs[2];
+
+    for (int16_t &value : input)
+        value = static_cast<int16_t>(random() % 512) - 256;
+    for (int16_t &value : rows)
+        value = static_cast<int16_t>(random() % 128) - 64;
+    for (int8_t &value : weights)
+        value = static_cast<int8_t>(random() % 255 - 127);
+    for (int32_t &value : bias)
+        value = static_cast<int32_t>(random() % 20000) - 10000;
+
+    const int16_t *added[2] = {&rows[0], &rows[SIZE]};
+    const int16_t *removed[2] = {&rows[2 * SIZE], &rows[3 * SIZE]};
+    const NnueKernels *kernelSets[2] = {&scalarKernels, &kernels};
+
+    for (int set = 0; set < 2; set++)
+    {
+        accumulators[set].resize(SIZE);
+        activations[set].resize(SIZE);
+        outputs[set].resize(OUTPUTS);
+
+        kernelSets[set]->updateAccumulator(input.data(), accumulators[set].data(), SIZE, added, 2, removed, 2);
+        kernelSets[set]->clippedRelu(accumulators[set].data(), activations[set].data(), SIZE);
+        kernelSets[set]->affine(activations[set].data(), SIZE, weights.data(), bias.data(), outputs[set].data(), OUTPUTS);
+    }
+
+    return accumulators[0] == accumulators[1] && activations[0] == activations[1] && outputs[0] == outputs[1];
+}
+
+template <typename T>
+static void writeRandomValues(std::ofstream &file, std::mt19937 &random, std::size_t count, int min, int max)
+{
+    std::uniform_int_distribution<int> distribution(min, max);
+
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const T value = static_cast<T>(distribution(random));
+        file.write(reinterpret_cast<const char *>(&value), sizeof(value));
+    }
+}
+
+/*
+ *   Write a network with random parameters in the file, always the same one.
+ *   The ranges keep the accumulators and the hidden layer inside the activation
+ *   range often enough to make the output depend on the position.
+ *   The values are written in the byte order of the cpu, little endian on x86
+ */
+static bool writeRandomNetwork(const std::string &path)
+{
+    std::ofstream file(path, std::ios::binary);
+    std::mt19937 random(20240607);
+
+    NnueHeader header{};
+    std::memcpy(header.magic, NNUE_MAGIC, sizeof(header.magic));
+    header.inputSize = NNUE_INPUT_SIZE;
+    header.l1Size = NNUE_L1_SIZE;
+    header.l2Size = NNUE_L2_SIZE;
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    writeRandomValues<int16_t>(file, random, static_cast<std::size_t>(NNUE_INPUT_SIZE) * NNUE_L1_SIZE, -20, 20);
+    writeRandomValues<int16_t>(file, random, NNUE_L1_SIZE, 0, 60);
+    writeRandomValues<int8_t>(file, random, NNUE_L2_SIZE * 2 * NNUE_L1_SIZE, -40, 40);
+    writeRandomValues<int32_t>(file, random, NNUE_L2_SIZE, -2000, 2000);
+    writeRandomValues<int8_t>(file, random, NNUE_L2_SIZE, -60, 60);
+    writeRandomValues<int32_t>(file, random, 1, 100, 100);
+
+    return static_cast<bool>(file);
+}
+
+/*
+ *   Walk the tree evaluating every node with the accumulators updated along the walk,
+ *   or computed from scratch in each node if fromScratch is true
+ */
+static void walkNnue(Board &board, int depth, AccumulatorStack &accumulators, bool fromScratch,
+                     int64_t &checksum, uint64_t &nodes)
+{
+    if (fromScratch)
+        accumulators.reset();
+
+    checksum += accumulators.evaluate(board);
+    nodes++;
+
+    if (depth == 0)
+        return;
+
+    MoveList moves;
+    generateLegalMoves(moves, board);
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        board.makeMove(moves.get(i));
+        accumulators.push(board);
+        walkNnue(board, depth - 1, accumulators, fromScratch, checksum, nodes);
+        board.unmakeMove(moves.get(i));
+        accumulators.pop();
+    }
+}
+
+/*
+ *   Walk the tree again evaluating every node from scratch and compare with the incremental scores
+ */
+static void checkNnue(Board &board, int depth, AccumulatorStack &accumulators, AccumulatorStack &fresh, int &failed)
+{
+    fresh.reset();
+
+    if (accumulators.evaluate(board) != fresh.evaluate(board) && failed++ < 10)
+        std::cout << "NNUE FAILED: " << board.fen() << std::endl;
+
+    if (depth == 0)
+        return;
+
+    MoveList moves;
+    generateLegalMoves(moves, board);
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        board.makeMove(moves.get(i));
+        accumulators.push(board);
+        checkNnue(board, depth - 1, accumulators, fresh, failed);
+        board.unmakeMove(moves.get(i));
+        accumulators.pop();
+    }
+}
+
+static void runNnueBenchmark(const char *name, int depth, bool fromScratch)
+{
+    auto accumulators = std::make_unique<AccumulatorStack>();
+    Board board;
+    int64_t checksum = 0;
+    uint64_t nodes = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for (const char *fen : rootPositions)
+    {
+        board.loadFen(fen);
+        accumulators->reset();
+        walkNnue(board, depth, *accumulators, fromScratch, checksum, nodes);
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+
+    printBenchmark(name, "nodes", nodes, std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+                   static_cast<uint64_t>(checksum));
+}
+
+int main(int argc, char *argv[])
+{
+    const int repetitions = argc > 1 ? std::atoi(argv[1]) : 5000;
+
+    Board board;
+    int nodeCount = 0;
+    int failed = 0;
+
+    // the pawn table is too big for the stack
+    auto pawnTable = std::make_unique<PawnTable>();
+
+    walkRootPositions(3, [&](const Board &position)
+                      {
+        nodeCount++;
+
+        if (evaluate(position, *pawnTable) != scanEvaluate(position) && failed++ < 10)
+            std::cout << "FAILED: " << position.fen() << std::endl; });
+
+    const std::vector<Board> sample = sampleRootPositions(3, SAMPLE_STEP);
+
+    std::cout << nodeCount << " positions checked, pawn table hit rate in the tree walk "
+              << pawnTable->getHits() * 100.0 / pawnTable->getProbes() << "%\n"
+              << sample.size() << " positions evaluated " << repetitions << " times\n\n";
+
+    runBenchmark("incremental", "evaluations", sample, repetitions, [&pawnTable](const Board &position)
+                 { return evaluate(position, *pawnTable); });
+
+    runBenchmark("scan", "evaluations", sample, repetitions, [](const Board &position)
+                 { return scanEvaluate(position); });
+
+    const bool randomNetwork = argc <= 2;
+    const std::string networkPath =
+        randomNetwork ? (std::filesystem::temp_directory_path() / "eval_bench_random.nnue").string() : argv[2];
+
+    if (randomNetwork && !writeRandomNetwork(networkPath))
+    {
+        std::cout << "Can not write the random network: " << networkPath << std::endl;
+        return 1;
+    }
+
+    const bool networkLoaded = network.load(networkPath);
+
+    if (randomNetwork)
+    {
+        // the mapping stays valid after the file is removed
+        std::filesystem::remove(networkPath);
+    }
+
+    if (!networkLoaded)
+    {
+        std::cout << "Invalid NNUE network: " << networkPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "\nNNUE " << (randomNetwork ? "random network" : networkPath) << ", " << nnueKernels.name << " kernels\n\n";
+
+    for (const NnueKernels *kernels : {&sse41Kernels, &avx2Kernels})
+    {
+        if (!kernelsSupported(*kernels))
+        {
+            std::cout << kernels->name << " kernels not supported by the cpu, not checked" << std::endl;
+        }
+        else if (!checkKernels(*kernels))
+        {
+            std::cout << "FAILED: " << kernels->name << " kernels do not match the scalar kernels" << std::endl;
+            failed++;
+        }
+    }
+
+    auto accumulators = std::make_unique<AccumulatorStack>();
+    auto fresh = std::make_unique<AccumulatorStack>();
+
+    for (const char *fen : rootPositions)
+    {
+        board.loadFen(fen);
+        accumulators->reset();
+        checkNnue(board, 3, *accumulators, *fresh, failed);
+    }
+
+    runNnueBenchmark("incremental", 3, false);
+    runNnueBenchmark("refresh", 3, true);
+
+    network.unload();
+
+    std::cout << "\n"
+              << (failed ? std::to_string(failed) + " positions FAILED" : "All positions OK") << std::endl;
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+/*
+    FEN parser and serializer benchmark
+
+    Collect the positions of the legal move tree of a few well known positions,
+    then parse and serialize all of them several times and report the positions
+    per second of each operation. Every position is checked to round trip through
+    the fen and through the packed representation, the packed positions should be
+    equal only for equal positions, and a position with more than 32 pieces
+    should not be packed. The packing and unpacking are timed too.
+    Return 1 if any position does not round trip.
+
+    Usage: fen_bench [repetitions]
+*/
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "benchUtils.hpp"
+#include "board.hpp"
+
+int main(int argc, char *argv[])
+{
+    const int repetitions = argc > 1 ? std::atoi(argv[1]) : 5;
+
+    Board board;
+    std::vector<std::string> positions;
+
+    walkRootPositions(2, [&positions](const Board &position)
+                      { positions.push_back(position.fen()); });
+
+    // round trip check
+    int failed = 0;
+    char buffer[MAX_FEN_LENGTH];
+
+    for (const std::string &fen : positions)
+    {
+        const FenError error = board.loadFen(fen, true);
+        board.fen(buffer);
+
+        if (error != FenError::NONE || fen != buffer)
+        {
+            std::cout << "FAILED: " << fen << " (" << fenErrorToString(error) << ")" << std::endl;
+            failed++;
+        }
+    }
+
+    // packed round trip check, the unpacked position should be packed again to the same bytes
+    Board unpacked;
+    std::vector<PackedBoard> packedPositions;
+    std::unordered_set<std::string> distinctFens(positions.begin(), positions.end());
+
+    for (const std::string &fen : positions)
+    {
+        PackedBoard packed, repacked;
+        board.loadFen(fen);
+
+        const bool packedOk = board.pack(packed);
+        unpacked.unpack(packed);
+
+        if (!packedOk || unpacked.fen() != fen || unpacked.zobristKey != board.zobristKey ||
+            !unpacked.pack(repacked) || repacked != packed || repacked.hash() != packed.hash())
+        {
+            std::cout << "FAILED pack: " << fen << std::endl;
+            failed++;
+        }
+
+        packedPositions.push_back(packed);
+    }
+
+    const std::unordered_set<PackedBoard> distinctPacked(packedPositions.begin(), packedPositions.end());
+
+    if (distinctPacked.size() != distinctFens.size())
+    {
+        std::cout << "FAILED: " << distinctFens.size() << " distinct positions packed to "
+                  << distinctPacked.size() << " distinct packed positions" << std::endl;
+        failed++;
+    }
+
+    // accepted without validation, it does not fit in the packed representation
+    PackedBoard tooManyPieces;
+    board.loadFen("rnbqkbnr/pppppppp/pppppppp/8/8/PPPPPPPP/PPPPPPPP/RNBQKBNR w - - 0 1");
+
+    if (board.pack(tooManyPieces))
+    {
+        std::cout << "FAILED: a position with " << std::popcount(board.AllPiecesBB) << " pieces was packed" << std::endl;
+        failed++;
+    }
+
+    std::cout << positions.size() << " positions, " << repetitions << " repetitions\n\n";
+
+    runBenchmark("parse", "positions", positions, repetitions, [&board](const std::string &fen)
+                 {
+        board.loadFen(fen);
+        return board.zobristKey; });
+
+    runBenchmark("parse + validate", "positions", positions, repetitions, [&board](const std::string &fen)
+                 { return static_cast<int>(board.loadFen(fen, true)); });
+
+    runBenchmark("unpack + pack", "positions", packedPositions, repetitions, [&unpacked](const PackedBoard &position)
+                 {
+        PackedBoard packed;
+        unpacked.unpack(position);
+        return unpacked.pack(packed) ? packed.hash() : 0; });
+
+    runBenchmark("unpack", "positions", packedPositions, repetitions, [&unpacked](const PackedBoard &position)
+                 {
+        unpacked.unpack(position);
+        return unpacked.zobristKey; });
+
+    // the position is loaded once and serialized several times, only the serialization is timed
+    std::chrono::steady_clock::duration serializeTime{0};
+    uint64_t checksum = 0;
+
+    for (const std::string &fen : positions)
+    {
+        board.loadFen(fen);
+
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int repetition = 0; repetition < repetitions; repetition++)
+            checksum += board.fen(buffer);
+
+        serializeTime += std::chrono::steady_clock::now() - start;
+    }
+
+    printBenchmark("serialize", "positions", static_cast<uint64_t>(positions.size()) * repetitions,
+                   std::chrono::duration_cast<std::chrono::microseconds>(serializeTime).count(), checksum);
+
+    std::cout << "\n"
+              << (failed ? std::to_string(failed) + " positions FAILED" : "All positions OK") << std::endl;
+
+    return failed ? 1 : 0;
+}
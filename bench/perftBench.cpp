@@ -0,0 +1,82 @@
+/*
+    Perft benchmark
+
+    Run perft on a fixed suite of positions, check the node counts against the
+    known values and report the time and nodes per second of each position.
+    Return 1 if any node count is wrong.
+
+    Known values: https://www.chessprogramming.org/Perft_Results
+*/
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+#include "board.hpp"
+#include "perft.hpp"
+
+struct PerftTest
+{
+    const char *name;
+    const char *fen;
+    int depth;
+    uint64_t nodes;
+};
+
+static const PerftTest perftSuite[] = {
+    {"Start", StartFEN, 5, 4865609},
+    {"Kiwipete", KiwipeteFEN, 4, 4085603},
+    {"EnPassant", EnPassantFEN, 4, 597967},
+    {"Promotion", PromotionFEN, 4, 6305663},
+    {"Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624},
+    {"Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 4, 422333},
+    {"Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 4, 2103487},
+    {"Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594},
+};
+
+int main()
+{
+    Board board;
+    uint64_t totalNodes = 0;
+    int64_t totalMs = 0;
+    int failed = 0;
+
+    for (const PerftTest &test : perftSuite)
+    {
+        board.loadFen(test.fen);
+
+        const auto start = std::chrono::steady_clock::now();
+        const uint64_t nodes = perft(board, test.depth);
+        const auto end = std::chrono::steady_clock::now();
+
+        const int64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        const bool ok = nodes == test.nodes;
+
+        totalNodes += nodes;
+        totalMs += elapsedMs;
+        failed += ok ? 0 : 1;
+
+        std::cout << std::left << std::setw(12) << test.name
+                  << " depth " << test.depth
+                  << "  nodes " << std::setw(10) << nodes
+                  << "  time " << std::setw(6) << elapsedMs << " ms"
+                  << "  nps " << std::setw(10) << nodes * 1000 / (elapsedMs > 0 ? elapsedMs : 1);
+
+        if (ok)
+            std::cout << "  OK" << std::endl;
+        else
+            std::cout << "  FAILED, expected " << test.nodes << std::endl;
+    }
+
+    std::cout << "\nTotal nodes: " << totalNodes << "\n"
+              << "Total time: " << totalMs << " ms\n"
+              << "Nodes/second: " << totalNodes * 1000 / (totalMs > 0 ? totalMs : 1) << std::endl;
+
+    if (failed)
+        std::cout << failed << " positions FAILED" << std::endl;
+    else
+        std::cout << "All positions OK" << std::endl;
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,150 @@
+/*
+    Move picker benchmark
+
+    Walk the legal move tree of a few well known positions and check that the
+    staged move picker returns every legal move of each position exactly once
+    and no other move. The killers of each check are the castling, en passant and
+    promotion moves of the position, moves of other positions of the tree that
+    may be illegal here, and the first legal move as transposition table move.
+    Then pick all the moves of a sample of the positions several times and
+    report the positions per second of the picker and of the legal move generator.
+
+    Return 1 if any position is not picked correctly.
+
+    Usage: picker_bench [repetitions]
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "benchUtils.hpp"
+#include "board.hpp"
+#include "moveGenerator.hpp"
+#include "movePicker.hpp"
+
+// one of each SAMPLE_STEP positions of the tree is taken in the timed runs
+constexpr int SAMPLE_STEP = 16;
+
+// history of the quiet moves, empty so the picker order only depends on the stages
+static const int history[64][64] = {};
+
+static bool isSpecial(Move move)
+{
+    return move.type() != MoveType::NORMAL;
+}
+
+/*
+ *   Return true if the picker returns every legal move of the position exactly once
+ */
+static bool picksAllMoves(const Board &board, Move ttMove, Move killer0, Move killer1)
+{
+    MoveList legalMoves;
+    generateLegalMoves(legalMoves, board);
+
+    int timesPicked[MAX_MOVES] = {0};
+
+    const Move killers[2] = {killer0, killer1};
+    MoveList moves;
+    MovePicker picker(board, moves, ttMove, killers, history);
+
+    for (Move move = picker.nextMove(); move != Move::none(); move = picker.nextMove())
+    {
+        int i = 0;
+
+        while (i < legalMoves.size() && legalMoves.get(i) != move)
+            i++;
+
+        // not a legal move of the position
+        if (i == legalMoves.size())
+            return false;
+
+        timesPicked[i]++;
+    }
+
+    for (int i = 0; i < legalMoves.size(); i++)
+    {
+        if (timesPicked[i] != 1)
+            return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const int repetitions = argc > 1 ? std::atoi(argv[1]) : 20;
+
+    // castling, en passant and promotion moves of all the positions of the tree
+    std::vector<Move> specialMoves;
+
+    walkRootPositions(3, [&specialMoves](const Board &board)
+                      {
+        MoveList moves;
+        generateLegalMoves(moves, board);
+
+        for (int i = 0; i < moves.size(); i++)
+            if (isSpecial(moves.get(i)))
+                specialMoves.push_back(moves.get(i)); });
+
+    int positions = 0, failed = 0;
+    std::size_t other = 0;
+
+    walkRootPositions(3, [&](const Board &board)
+                      {
+        MoveList moves;
+        generateLegalMoves(moves, board);
+
+        const Move first = moves.size() > 0 ? moves.get(0) : Move::none();
+        const Move otherMove = specialMoves[other++ % specialMoves.size()];
+        bool ok = picksAllMoves(board, Move::none(), otherMove, specialMoves[other % specialMoves.size()]) &&
+                  picksAllMoves(board, first, first, otherMove);
+
+        for (int i = 0; i < moves.size(); i++)
+        {
+            if (isSpecial(moves.get(i)))
+            {
+                ok = ok && picksAllMoves(board, Move::none(), moves.get(i), otherMove) &&
+                     picksAllMoves(board, first, otherMove, moves.get(i));
+            }
+        }
+
+        positions++;
+
+        if (!ok)
+        {
+            failed++;
+            std::cout << "FAILED: " << board.fen() << std::endl;
+        } });
+
+    std::cout << "positions " << positions << "  special moves " << specialMoves.size()
+              << "  repetitions " << repetitions << std::endl;
+
+    const std::vector<Board> sample = sampleRootPositions(3, SAMPLE_STEP);
+
+    runBenchmark("picker", "positions", sample, repetitions, [](const Board &board)
+                 {
+        const Move killers[2] = {Move::none(), Move::none()};
+        MoveList moves;
+        MovePicker picker(board, moves, Move::none(), killers, history);
+        int count = 0;
+
+        while (picker.nextMove() != Move::none())
+            count++;
+
+        return count; });
+
+    runBenchmark("generate", "positions", sample, repetitions, [](const Board &board)
+                 {
+        MoveList moves;
+        generateLegalMoves(moves, board);
+        return moves.size(); });
+
+    if (failed)
+        std::cout << failed << " positions FAILED" << std::endl;
+    else
+        std::cout << "All positions OK" << std::endl;
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+/*
+    Static exchange evaluation benchmark
+
+    Check the static exchange evaluation of a few captures with known results,
+    the move should reach the expected balance and not one more centipawn.
+    Then walk the legal move tree of a few well known positions, take a sample
+    of the positions with captures and order their captures several times by
+    most valuable victim - least valuable attacker and by static exchange
+    evaluation, and report the positions per second of each one and the
+    captures that lose material.
+
+    Return 1 if any capture does not match.
+
+    Usage: see_bench [repetitions]
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "benchUtils.hpp"
+#include "board.hpp"
+#include "evaluation.hpp"
+#include "moveGenerator.hpp"
+#include "movePicker.hpp"
+
+struct SeeTest
+{
+    const char *fen;
+    const char *move;
+    int balance;
+};
+
+constexpr int PAWN_VALUE = pieceValue[static_cast<int>(PieceType::PAWN)];
+constexpr int KNIGHT_VALUE = pieceValue[static_cast<int>(PieceType::KNIGHT)];
+constexpr int BISHOP_VALUE = pieceValue[static_cast<int>(PieceType::BISHOP)];
+constexpr int ROOK_VALUE = pieceValue[static_cast<int>(PieceType::ROOK)];
+
+static const SeeTest seeTests[] = {
+    // undefended pawn
+    {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", "e1e5", PAWN_VALUE},
+    // the knight is lost after the exchanges on e5
+    {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", "d3e5", PAWN_VALUE - KNIGHT_VALUE},
+    // defended by the rook behind the other rook
+    {"4R3/2r3p1/5bk1/1p1r3p/p2PR1P1/P1BK1P2/1P6/8 b - - 0 1", "h5g4", 0},
+    // the queen behind the bishop recaptures
+    {"4r1k1/5pp1/nbp4p/1p2p2q/1P2P1b1/1BP2N1P/1B2QPPK/3R4 b - - 0 1", "g4f3", KNIGHT_VALUE - BISHOP_VALUE},
+    {"2r1r1k1/pp1bppbp/3p1np1/q3P3/2P2P2/1P2B3/P1N1B1PP/2RQ1RK1 b - - 0 1", "d6e5", PAWN_VALUE},
+    {"6rr/6pk/p1Qp1b1p/2n5/1B3p2/5p2/P1P2P2/4RK1R w - - 0 1", "e1e8", -ROOK_VALUE},
+    // quiet move to a square attacked by a pawn
+    {"1k6/8/8/4p3/8/3N4/8/1K6 w - - 0 1", "d3f4", -KNIGHT_VALUE},
+    // the king can not recapture a defended piece
+    {"8/8/8/4k3/3r4/2P5/8/3QK3 w - - 0 1", "d1d4", ROOK_VALUE},
+    {"4k3/4r3/8/8/4r3/8/8/4QK2 w - - 0 1", "e1e4", ROOK_VALUE - pieceValue[static_cast<int>(PieceType::QUEEN)]},
+};
+
+// one of each SAMPLE_STEP positions of the tree is taken in the timed runs
+constexpr int SAMPLE_STEP = 64;
+
+static Move findMove(const Board &board, const std::string &moveString)
+{
+    MoveList moves;
+    generateLegalMoves(moves, board);
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        if (moves.get(i).toString() == moveString)
+            return moves.get(i);
+    }
+
+    return Move::none();
+}
+
+static int runSeeTests()
+{
+    int failed = 0;
+
+    for (const SeeTest &test : seeTests)
+    {
+        Board board;
+        board.loadFen(test.fen);
+        const Move move = findMove(board, test.move);
+
+        const bool passed = move.isValid() && board.see(move, test.balance) && !board.see(move, test.balance + 1);
+
+        if (!passed)
+        {
+            failed++;
+            std::cout << "FAILED: " << test.fen << " " << test.move << " expected " << test.balance << std::endl;
+        }
+    }
+
+    std::cout << "see tests " << (sizeof(seeTests) / sizeof(seeTests[0]) - failed) << "/"
+              << sizeof(seeTests) / sizeof(seeTests[0]) << std::endl;
+
+    return failed;
+}
+
+/*
+ *   Generate the captures of the position, score them with the function and select the
+ *   best one like the move picker, return the index plus the score of the best capture as checksum
+ */
+template <typename Score>
+static int selectBestCapture(const Board &board, Score score)
+{
+    MoveList captures;
+    generate<GenType::CAPTURES>(captures, board);
+
+    int best = 0, bestScore = score(board, captures.get(0));
+
+    for (int i = 1; i < captures.size(); i++)
+    {
+        const int captureScore = score(board, captures.get(i));
+
+        if (captureScore > bestScore)
+        {
+            best = i;
+            bestScore = captureScore;
+        }
+    }
+
+    return best + bestScore;
+}
+
+int main(int argc, char *argv[])
+{
+    const int repetitions = argc > 1 ? std::atoi(argv[1]) : 200;
+
+    if (runSeeTests() > 0)
+    {
+        return 1;
+    }
+
+    const std::vector<Board> sample = sampleRootPositions(3, SAMPLE_STEP, [](const Board &board)
+                                                          {
+        MoveList captures;
+        generate<GenType::CAPTURES>(captures, board);
+        return captures.size() > 0; });
+
+    uint64_t captureCount = 0, losingCount = 0;
+
+    for (const Board &board : sample)
+    {
+        MoveList captures;
+        generate<GenType::CAPTURES>(captures, board);
+
+        for (int i = 0; i < captures.size(); i++)
+        {
+            captureCount++;
+            losingCount += board.see(captures.get(i), 0) ? 0 : 1;
+        }
+    }
+
+    std::cout << "positions " << sample.size() << "  captures " << captureCount
+              << "  losing captures " << losingCount * 100 / (captureCount > 0 ? captureCount : 1) << "%"
+              << "  repetitions " << repetitions << std::endl;
+
+    runBenchmark("mvv-lva", "positions", sample, repetitions, [](const Board &board)
+                 { return selectBestCapture(board, mvvLvaScore); });
+
+    // winning and equal captures first, then most valuable victim - least valuable attacker
+    runBenchmark("see", "positions", sample, repetitions, [](const Board &board)
+                 { return selectBestCapture(board, [](const Board &position, Move move)
+                                            { return (position.see(move, 0) ? 1 << 16 : 0) + mvvLvaScore(position, move); }); });
+
+    return 0;
+}
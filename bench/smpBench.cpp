@@ -0,0 +1,82 @@
+/*
+    Lazy SMP scaling benchmark
+
+    Search a fixed suite of positions to a fixed depth with 1, 2, 4 ... N threads
+    and report the nodes per second and the time to depth of each thread count.
+
+    Usage: smp_bench [depth] [max threads]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include "board.hpp"
+#include "threadPool.hpp"
+#include "transpositionTable.hpp"
+
+static const char *benchPositions[] = {
+    StartFEN,
+    KiwipeteFEN,
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+int main(int argc, char *argv[])
+{
+    const int depth = argc > 1 ? std::atoi(argv[1]) : 7;
+    const int maxThreads = argc > 2 ? std::atoi(argv[2]) : std::max(1U, std::thread::hardware_concurrency());
+
+    Board board;
+    ThreadPool threadPool;
+    SearchLimits limits;
+    int64_t singleThreadMs = 0;
+    uint64_t singleThreadNps = 0;
+
+    limits.depth = depth;
+    threadPool.setVerbose(false);
+
+    std::cout << "depth " << depth << ", " << std::size(benchPositions) << " positions\n\n"
+              << std::left << std::setw(9) << "threads" << std::setw(12) << "nodes" << std::setw(10) << "time ms"
+              << std::setw(12) << "nps" << std::setw(14) << "nps scaling" << "time to depth speedup" << std::endl;
+
+    for (int threads = 1; threads <= maxThreads; threads = threads < maxThreads ? std::min(threads * 2, maxThreads) : threads + 1)
+    {
+        threadPool.setThreads(threads);
+
+        uint64_t nodes = 0;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (const char *fen : benchPositions)
+        {
+            transpositionTable.clear(threads);
+            board.loadFen(fen);
+
+            threadPool.startSearch(board, limits);
+            threadPool.waitForSearchFinished();
+
+            nodes += threadPool.nodesSearched();
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+        const int64_t elapsedMs = std::max<int64_t>(1, std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+        const uint64_t nps = nodes * 1000 / elapsedMs;
+
+        if (threads == 1)
+        {
+            singleThreadMs = elapsedMs;
+            singleThreadNps = nps;
+        }
+
+        std::cout << std::setw(9) << threads << std::setw(12) << nodes << std::setw(10) << elapsedMs
+                  << std::setw(12) << nps
+                  << std::setw(14) << std::fixed << std::setprecision(2) << static_cast<double>(nps) / singleThreadNps
+                  << static_cast<double>(singleThreadMs) / elapsedMs << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,306 @@
+#include "analysis.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "board.hpp"
+#include "mappedFile.hpp"
+#include "nnue.hpp"
+#include "threadPool.hpp"
+
+// parts of the input for each analysis thread, small parts balance the work at the end of the file
+constexpr std::size_t CHUNKS_PER_THREAD = 64;
+
+/*
+ *   State shared by the analysis threads.
+ *   The input is split in chunks that end at a line break, each thread takes the next
+ *   chunk and searches all its positions, the chunks are handed out with an atomic counter.
+ *   Each result is identified by its chunk and its position in the chunk, the results that
+ *   arrive before the previous ones wait in pending, so the output keeps the order of the input.
+ */
+struct AnalysisState
+{
+    AnalysisState(const MappedFile &file, std::size_t chunkSize)
+        : file(file), chunks(file.split(chunkSize)), chunkPositions(chunks.size(), UNKNOWN_POSITIONS) {}
+
+    static constexpr uint64_t UNKNOWN_POSITIONS = ~0ULL;
+
+    const MappedFile &file;
+    const std::vector<std::string_view> chunks;
+    std::atomic<std::size_t> nextChunk = 0;
+
+    std::mutex outputMutex;
+    std::map<std::pair<std::size_t, uint64_t>, std::string> pending;
+    std::vector<uint64_t> chunkPositions; // positions of each chunk, known when the chunk is finished
+    std::size_t outputChunk = 0;
+    uint64_t outputPosition = 0;
+    uint64_t positions = 0;
+    uint64_t totalNodes = 0;
+};
+
+static void printUsage()
+{
+    std::cerr << "Usage: AlphaDeepChess analyse --input <file> --depth <N> [--threads <T>] [--hash <MB>] [--eval-file <network>]" << std::endl;
+}
+
+bool parseAnalysisOptions(int argc, char *argv[], AnalysisOptions &options)
+{
+    for (int i = 0; i < argc; i++)
+    {
+        const std::string argument = argv[i];
+
+        if (i + 1 >= argc)
+        {
+            printUsage();
+            return false;
+        }
+
+        const char *value = argv[++i];
+
+        if (argument == "--input")
+        {
+            options.input = value;
+        }
+        else if (argument == "--depth")
+        {
+            options.depth = std::clamp(std::atoi(value), 1, MAX_PLY - 1);
+        }
+        else if (argument == "--threads")
+        {
+            options.threads = std::clamp(std::atoi(value), MIN_THREADS, MAX_THREADS);
+        }
+        else if (argument == "--hash")
+        {
+            options.hashSizeMB = std::clamp(std::atoi(value), TT_MIN_SIZE_MB, TT_MAX_SIZE_MB);
+        }
+        else if (argument == "--eval-file")
+        {
+            options.evalFile = value;
+        }
+        else
+        {
+            printUsage();
+            return false;
+        }
+    }
+
+    if (options.input.empty())
+    {
+        printUsage();
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ *   Write all the results that are next in the input order, the lock should be held
+ */
+static void flushResults(AnalysisState &state)
+{
+    std::string output;
+
+    while (state.outputChunk < state.chunks.size())
+    {
+        const auto next = state.pending.begin();
+
+        if (next != state.pending.end() && next->first == std::make_pair(state.outputChunk, state.outputPosition))
+        {
+            output += next->second;
+            state.pending.erase(next);
+            state.outputPosition++;
+            state.positions++;
+        }
+        else if (state.chunkPositions[state.outputChunk] == state.outputPosition)
+        {
+            state.outputChunk++;
+            state.outputPosition = 0;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (!output.empty())
+    {
+        std::cout << output << std::flush;
+    }
+}
+
+/*
+ *   Store the result of the position of the chunk and write the results that are next in the input order
+ */
+static void writeResult(AnalysisState &state, std::size_t chunk, uint64_t position, std::string result, uint64_t nodes)
+{
+    std::lock_guard<std::mutex> lock(state.outputMutex);
+
+    state.pending.emplace(std::make_pair(chunk, position), std::move(result));
+    state.totalNodes += nodes;
+
+    flushResults(state);
+}
+
+/*
+ *   All the positions of the chunk are searched, the results of the next chunks can be written after them
+ */
+static void finishChunk(AnalysisState &state, std::size_t chunk, uint64_t positions)
+{
+    std::lock_guard<std::mutex> lock(state.outputMutex);
+
+    state.chunkPositions[chunk] = positions;
+
+    flushResults(state);
+}
+
+/*
+ *   Search the position and return its EPD result line
+ */
+static std::string analysePosition(ThreadPool &threadPool, Board &board, std::string_view line, const SearchLimits &limits)
+{
+    board.loadFen(line);
+
+    if (std::popcount(board.bitBoards[index(Piece::WKing)]) != 1 || std::popcount(board.bitBoards[index(Piece::BKing)]) != 1)
+    {
+        return "# invalid position: " + std::string(line) + "\n";
+    }
+
+    threadPool.startSearch(board, limits);
+    threadPool.waitForSearchFinished();
+
+    const SearchWorker &worker = threadPool.mainWorker();
+    const int score = worker.getBestScore();
+    const Move bestMove = worker.getBestMove();
+
+    // the position fields of the fen, without the clocks
+    char fen[MAX_FEN_LENGTH];
+    board.fen(fen);
+    std::string_view position(fen);
+    std::size_t positionLength = 0;
+
+    for (int field = 0; field < 4; field++)
+    {
+        positionLength = position.find(' ', positionLength) + 1;
+    }
+
+    position = position.substr(0, positionLength - 1);
+
+    std::ostringstream result;
+
+    result << position << " bm " << (bestMove == Move::none() ? "0000" : bestMove.toString()) << "; ce " << score << ";";
+
+    if (score >= MATE_IN_MAX_PLY)
+    {
+        result << " dm " << (MATE_SCORE - score + 1) / 2 << ";";
+    }
+
+    result << " acd " << worker.getCompletedDepth() << "; acn " << worker.getNodes() << ";\n";
+
+    return result.str();
+}
+
+/*
+ *   Each analysis thread has its own board and a single thread pool to search the positions.
+ *   The lines of each chunk are walked without locks, the next chunk is read ahead when
+ *   a chunk is taken and the chunk is released when all its positions are searched
+ */
+static void analysisThread(AnalysisState &state, const SearchLimits &limits)
+{
+    ThreadPool threadPool;
+    Board board;
+    std::size_t chunk;
+
+    threadPool.setVerbose(false);
+    // the generation of the shared table is started once by analyse(), the age would wrap every 64 positions
+    threadPool.setNewGenerationPerSearch(false);
+
+    while ((chunk = state.nextChunk.fetch_add(1, std::memory_order_relaxed)) < state.chunks.size())
+    {
+        if (chunk + 1 < state.chunks.size())
+        {
+            state.file.adviseWillNeed(state.chunks[chunk + 1]);
+        }
+
+        std::string_view text = state.chunks[chunk];
+        std::string_view line;
+        uint64_t position = 0;
+
+        while (nextLine(text, line))
+        {
+            const std::size_t start = line.find_first_not_of(" \t");
+
+            if (start == std::string_view::npos || line[start] == '#')
+            {
+                continue;
+            }
+
+            std::string result = analysePosition(threadPool, board, line, limits);
+            writeResult(state, chunk, position++, std::move(result), threadPool.nodesSearched());
+        }
+
+        finishChunk(state, chunk, position);
+        state.file.adviseDontNeed(state.chunks[chunk]);
+    }
+}
+
+int analyse(const AnalysisOptions &options)
+{
+    // the lines are views of the mapping, they are not copied
+    MappedFile file;
+
+    if (!file.open(options.input))
+    {
+        std::cerr << "Can not open " << options.input << std::endl;
+        return 1;
+    }
+
+    if (!options.evalFile.empty() && !network.load(options.evalFile))
+    {
+        std::cerr << "Invalid NNUE network " << options.evalFile << std::endl;
+        return 1;
+    }
+
+    transpositionTable.resize(options.hashSizeMB, options.threads);
+    transpositionTable.newSearch();
+
+    // the chunks are smaller than MAPPED_FILE_CHUNK_SIZE for small files, so all the threads have work
+    const std::size_t chunkSize =
+        std::clamp<std::size_t>(file.view().size() / (options.threads * CHUNKS_PER_THREAD), 1, MAPPED_FILE_CHUNK_SIZE);
+
+    AnalysisState state(file, chunkSize);
+    SearchLimits limits;
+    limits.depth = options.depth;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < options.threads; i++)
+    {
+        threads.emplace_back(analysisThread, std::ref(state), std::cref(limits));
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    const int64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cerr << "Positions: " << state.positions << "\n"
+              << "Nodes searched: " << state.totalNodes << "\n"
+              << "Time: " << elapsedMs << " ms\n"
+              << "Positions/second: " << state.positions * 1000 / (elapsedMs > 0 ? elapsedMs : 1) << std::endl;
+
+    return 0;
+}
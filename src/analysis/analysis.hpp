@@ -0,0 +1,36 @@
+#pragma once
+
+/*
+    Batch analysis of a file of positions, one FEN or EPD position per line.
+
+    AlphaDeepChess analyse --input positions.epd --depth N [--threads T] [--hash MB] [--eval-file network.nnue]
+
+    The mapped input is split in chunks that end at a line break, each thread
+    takes the next chunk and searches its positions with its own board and
+    search state, the transposition table is shared. The results are written
+    to the standard output in the order of the input as soon as they are
+    available, one EPD line for each position:
+
+    <position> bm <best move>; ce <score>; acd <depth>; acn <nodes>;
+
+    Empty lines and lines starting with '#' are skipped.
+*/
+
+#include <string>
+
+#include "transpositionTable.hpp"
+
+struct AnalysisOptions
+{
+    std::string input;
+    int depth = 8;
+    int threads = 1;
+    int hashSizeMB = TT_DEFAULT_SIZE_MB;
+    std::string evalFile; // NNUE network, empty for the classical evaluation
+};
+
+// parse the arguments that follow "analyse", return false and print the usage if they are not valid
+bool parseAnalysisOptions(int argc, char *argv[], AnalysisOptions &options);
+
+// analyse all the positions of the input file, return the exit code of the program
+int analyse(const AnalysisOptions &options);
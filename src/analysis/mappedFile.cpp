@@ -0,0 +1,143 @@
+#include "mappedFile.hpp"
+
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    size = static_cast<std::size_t>(info.st_size);
+
+    // an empty file can not be mapped, it is an empty view
+    if (size > 0)
+    {
+        address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (address == MAP_FAILED)
+        {
+            address = nullptr;
+            size = 0;
+            ::close(fd);
+            return false;
+        }
+
+        // the file is read from the start to the end
+        madvise(address, size, MADV_SEQUENTIAL);
+    }
+
+    // the mapping keeps the file open
+    ::close(fd);
+
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (address != nullptr)
+    {
+        munmap(address, size);
+    }
+
+    address = nullptr;
+    size = 0;
+}
+
+std::vector<std::string_view> MappedFile::split(std::size_t partSize) const
+{
+    const std::string_view text = view();
+    std::vector<std::string_view> parts;
+    std::size_t start = 0;
+
+    while (start < text.size())
+    {
+        std::size_t end = start + partSize;
+
+        if (end >= text.size())
+        {
+            end = text.size();
+        }
+        else
+        {
+            // extend the part to the end of the line, a line longer than the part stays whole
+            const std::size_t lineBreak = text.find('\n', end - 1);
+            end = lineBreak == std::string_view::npos ? text.size() : lineBreak + 1;
+        }
+
+        parts.push_back(text.substr(start, end - start));
+        start = end;
+    }
+
+    return parts;
+}
+
+/*
+ *   madvise works on whole pages, the part is extended to the page boundaries
+ */
+static void advise(const void *mappingAddress, std::string_view part, int advice)
+{
+    if (mappingAddress == nullptr || part.empty())
+    {
+        return;
+    }
+
+    static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+    const uintptr_t start = reinterpret_cast<uintptr_t>(part.data()) & ~(pageSize - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(part.data()) + part.size();
+
+    madvise(reinterpret_cast<void *>(start), end - start, advice);
+}
+
+void MappedFile::adviseWillNeed(std::string_view part) const
+{
+    advise(address, part, MADV_WILLNEED);
+}
+
+void MappedFile::adviseDontNeed(std::string_view part) const
+{
+    // the mapping is read only, the released pages are read again from the file if needed
+    advise(address, part, MADV_DONTNEED);
+}
+
+bool nextLine(std::string_view &text, std::string_view &line)
+{
+    if (text.empty())
+    {
+        return false;
+    }
+
+    // the last line of the file may not have a line break
+    const std::size_t lineBreak = text.find('\n');
+    const std::size_t length = lineBreak == std::string_view::npos ? text.size() : lineBreak;
+
+    line = text.substr(0, length);
+    text.remove_prefix(lineBreak == std::string_view::npos ? text.size() : lineBreak + 1);
+
+    // windows line breaks
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.remove_suffix(1);
+    }
+
+    return true;
+}
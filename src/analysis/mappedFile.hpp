@@ -0,0 +1,57 @@
+#pragma once
+
+/*
+    Memory mapped text files, the file is split in parts of whole lines and
+    the lines are returned as string_views of the mapping so they are never
+    copied. Used to read huge FEN and EPD files and the weights of the neural
+    network.
+*/
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// max size of the parts of the file that are read ahead and released as a whole
+#define MAPPED_FILE_CHUNK_SIZE (16 * 1024 * 1024)
+
+/*
+ *   Read only mapping of a whole file
+ */
+class MappedFile
+{
+public:
+    MappedFile() : address(nullptr), size(0) {}
+
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // map the file, return false if it can not be opened
+    bool open(const std::string &path);
+
+    void close();
+
+    inline std::string_view view() const { return std::string_view(static_cast<const char *>(address), size); }
+
+    /*
+     *   Split the file in parts of about partSize bytes, each part ends at the end of a line,
+     *   so the parts can be processed by different threads without cutting any line
+     */
+    std::vector<std::string_view> split(std::size_t partSize) const;
+
+    // hint the kernel that the part will be read soon / will not be read again
+    void adviseWillNeed(std::string_view part) const;
+    void adviseDontNeed(std::string_view part) const;
+
+private:
+    void *address;
+    std::size_t size;
+};
+
+/*
+ *   Take the first line of the text without the line break and remove it from the text,
+ *   return false if the text is empty. Used to walk the parts returned by MappedFile::split
+ */
+bool nextLine(std::string_view &text, std::string_view &line);
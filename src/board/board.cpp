@@ -1,8 +1,18 @@
 #include "board.hpp"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cctype>
+#include <charconv>
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 
+#include "evaluation.hpp"
+#include "precomputedData.hpp"
+
 std::string Board::toString() const
 {
     std::ostringstream diagram;
@@ -22,11 +32,69 @@ std::string Board::toString() const
     return diagram.str();
 }
 
+std::string_view fenErrorToString(FenError error)
+{
+    switch (error)
+    {
+    case FenError::NONE:
+        return "no error";
+    case FenError::PIECE_PLACEMENT:
+        return "invalid piece placement";
+    case FenError::SIDE_TO_MOVE:
+        return "invalid side to move";
+    case FenError::CASTLING:
+        return "invalid castling rights";
+    case FenError::EN_PASSANT:
+        return "invalid en passant square";
+    case FenError::HALFMOVE:
+        return "invalid halfmove clock";
+    case FenError::FULLMOVE:
+        return "invalid fullmove number";
+    case FenError::KINGS:
+        return "each side should have one king";
+    case FenError::PAWNS:
+        return "pawns on the first or last row";
+    case FenError::TRAILING_CHARACTERS:
+        return "unexpected characters after the fullmove number";
+    default:
+        return "unknown error";
+    }
+}
+
+/*
+ *   Return the next field of the fen separated by spaces, empty if there are no more fields
+ */
+static std::string_view nextFenField(std::string_view fen, std::size_t &position)
+{
+    while (position < fen.size() && std::isspace(static_cast<unsigned char>(fen[position])))
+        position++;
+
+    const std::size_t start = position;
+
+    while (position < fen.size() && !std::isspace(static_cast<unsigned char>(fen[position])))
+        position++;
+
+    return fen.substr(start, position - start);
+}
+
 /*
- *   Set the position on the board stored in fen notation
- *   Return false if fen is incorrectly formatted or error happens
+ *   Parse the whole field as a number, return false if it is not a number
  */
-void Board::loadFen(const std::string &fen)
+static bool parseFenNumber(std::string_view field, uint16_t &number)
+{
+    const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), number);
+    return error == std::errc() && end == field.data() + field.size();
+}
+
+/*
+ *   Set the position on the board stored in fen notation, without allocations.
+ *
+ *   By default the parser is permissive: unknown characters are skipped and the
+ *   missing fields keep their default values (EPD lines can be loaded directly).
+ *   With validate the first error found is returned, the board is then left
+ *   with the fields parsed until the error.
+ */
+FenError Board::loadFen(std::string_view fen, bool validate)
 {
 
     /*
@@ -38,131 +106,320 @@ void Board::loadFen(const std::string &fen)
 
     clearPosition();
 
-    int row = ROW_8, col = COL_A;
-    char token;
-    Piece piece;
-    std::istringstream ss(fen);
+    sideToMove = Color::WHITE;
+    castleRights = NO_CASTLE;
+    enPassantSquare.setInvalid();
+    halfmove = 0;
+    moveNumber = 1;
+    historyPly = 0;
 
-    ss >> std::noskipws;
+    std::size_t position = 0;
+    std::string_view field;
 
     // 1. Piece placement
-    while ((ss >> token) && !isspace(token))
+    int row = ROW_8, col = COL_A;
+    field = nextFenField(fen, position);
+
+    for (char token : field)
     {
-        if (isdigit(token))
+        Piece piece;
+
+        if (token >= '1' && token <= '8')
         {
             col += (token - '0'); // Advance the given number of columns
         }
         else if (token == '/')
         {
+            if (validate && col != COL_H + 1)
+                return FenError::PIECE_PLACEMENT;
+
             row -= 1; // Advance to the next row
             col = COL_A;
         }
-        else if ((piece = charToPiece(token)) != Piece::Empty)
+        else if ((piece = charToPiece(token)) != Piece::Empty && validCoord(row, col))
         {
             putPiece(piece, {row, col});
             col++;
         }
+        else if (validate)
+        {
+            return FenError::PIECE_PLACEMENT;
+        }
+
+        if (validate && (row < ROW_1 || col > COL_H + 1))
+            return FenError::PIECE_PLACEMENT;
+    }
+
+    if (validate)
+    {
+        if (row != ROW_1 || col != COL_H + 1)
+            return FenError::PIECE_PLACEMENT;
+
+        if (std::popcount(bitBoards[index(Piece::WKing)]) != 1 || std::popcount(bitBoards[index(Piece::BKing)]) != 1)
+            return FenError::KINGS;
+
+        constexpr uint64_t FIRST_AND_LAST_ROW = 0xFF000000000000FFULL;
+
+        if ((bitBoards[index(Piece::WPawn)] | bitBoards[index(Piece::BPawn)]) & FIRST_AND_LAST_ROW)
+            return FenError::PAWNS;
     }
 
     // 2. Active color
-    ss >> token;
-    sideToMove = (token == 'w' ? Color::WHITE : Color::BLACK);
-    ss >> token;
+    field = nextFenField(fen, position);
+
+    if (field == "b")
+        sideToMove = Color::BLACK;
+    else if (validate && field != "w")
+        return FenError::SIDE_TO_MOVE;
 
     // 3. Castling availability.
-    while ((ss >> token) && !isspace(token))
+    field = nextFenField(fen, position);
+
+    for (char token : field)
     {
         if (token == 'K')
-        {
-            // white king castle
-            castleKWhite = true;
-        }
+            castleRights |= WHITE_KING_CASTLE;
         else if (token == 'Q')
-        {
-            // white queen castle
-            castleQWhite = true;
-        }
+            castleRights |= WHITE_QUEEN_CASTLE;
         else if (token == 'k')
-        {
-            // black king castle
-            castleKBlack = true;
-        }
+            castleRights |= BLACK_KING_CASTLE;
         else if (token == 'q')
-        {
-            // black queen castle
-            castleQBlack = true;
-        }
+            castleRights |= BLACK_QUEEN_CASTLE;
+        else if (validate && (token != '-' || field.size() != 1))
+            return FenError::CASTLING;
     }
 
+    if (validate && field.empty())
+        return FenError::CASTLING;
+
+    const uint8_t fenCastleRights = castleRights;
     checkAndModifyCastleRights();
 
+    if (validate && castleRights != fenCastleRights)
+        return FenError::CASTLING;
+
     // 4. En passant square.
+    field = nextFenField(fen, position);
 
-    ss >> std::skipws >> token;
-    if (token != '-')
+    if (field.size() == 2 && field[0] >= 'a' && field[0] <= 'h' && (field[1] == '3' || field[1] == '6'))
     {
-        col = token - 'a';
-        ss >> token;
-        row = token - '1';
-
-        enPassantSquare = Square(row, col);
+        enPassantSquare = Square(field[1] - '1', field[0] - 'a');
         checkAndModifyEnPassantRule();
     }
+    else if (validate && field != "-")
+    {
+        return FenError::EN_PASSANT;
+    }
+
+    // 5-6. Halfmove clock and fullmove number, optional
+    field = nextFenField(fen, position);
+
+    if (!field.empty() && !parseFenNumber(field, halfmove) && validate)
+        return FenError::HALFMOVE;
+
+    field = nextFenField(fen, position);
+
+    if (!field.empty() && (!parseFenNumber(field, moveNumber) || moveNumber == 0) && validate)
+        return FenError::FULLMOVE;
+
+    if (validate && !nextFenField(fen, position).empty())
+        return FenError::TRAILING_CHARACTERS;
 
-    // 5-6. Halfmove clock and fullmove number
-    ss >> std::skipws >> halfmove >> moveNumber;
+    // putPiece already added the keys of the pieces
+    zobristKey ^= zobrist.getCastleKey(castleRights);
+
+    if (enPassantSquare.isValid())
+        zobristKey ^= zobrist.getEnPassantKey(enPassantSquare);
+
+    if (sideToMove == Color::BLACK)
+        zobristKey ^= zobrist.getSideKey();
+
+    assert(zobristKey == computeZobristKey());
+
+    return FenError::NONE;
 }
 
 /*
-    Returns fen representation of the position
-*/
-std::string Board::fen() const
+ *   Calculate the zobrist key of the position from scratch
+ */
+uint64_t Board::computeZobristKey() const
+{
+    uint64_t key = 0;
+
+    for (Square square = SQ_A1; square <= SQ_H8; square++)
+    {
+        if (!empty(square))
+        {
+            key ^= zobrist.getPieceKey(getPiece(square), square);
+        }
+    }
+
+    key ^= zobrist.getCastleKey(getCastleRights());
+
+    if (enPassantSquare.isValid())
+    {
+        key ^= zobrist.getEnPassantKey(enPassantSquare);
+    }
+
+    if (sideToMove == Color::BLACK)
+    {
+        key ^= zobrist.getSideKey();
+    }
+
+    return key;
+}
+
+/*
+ *   Write the fen representation of the position in the buffer, without allocations.
+ *   The buffer should have at least MAX_FEN_LENGTH characters.
+ *   Return the length of the fen, the null character is not counted
+ */
+int Board::fen(char *buffer) const
 {
-    int emptyCounter;
-    std::ostringstream fen;
+    char *out = buffer;
 
     for (int row = ROW_8; row >= ROW_1; row--)
     {
+        int emptyCounter = 0;
+
         for (int col = COL_A; col <= COL_H; col++)
         {
-            emptyCounter = 0;
-            while (col <= COL_H && empty(Square(row, col)))
+            const Square square(row, col);
+
+            if (empty(square))
             {
                 emptyCounter++;
-                col++;
-            };
+                continue;
+            }
 
             if (emptyCounter)
-                fen << emptyCounter;
+                *out++ = static_cast<char>('0' + emptyCounter);
 
-            if (col <= 7)
-                fen << squareToChar(Square(row, col));
+            emptyCounter = 0;
+            *out++ = squareToChar(square);
         }
 
-        if (row > 0)
-            fen << '/';
+        if (emptyCounter)
+            *out++ = static_cast<char>('0' + emptyCounter);
+
+        if (row > ROW_1)
+            *out++ = '/';
+    }
+
+    *out++ = ' ';
+    *out++ = sideToMove == Color::WHITE ? 'w' : 'b';
+    *out++ = ' ';
+
+    if (castleRights & WHITE_KING_CASTLE)
+        *out++ = 'K';
+    if (castleRights & WHITE_QUEEN_CASTLE)
+        *out++ = 'Q';
+    if (castleRights & BLACK_KING_CASTLE)
+        *out++ = 'k';
+    if (castleRights & BLACK_QUEEN_CASTLE)
+        *out++ = 'q';
+    if (castleRights == NO_CASTLE)
+        *out++ = '-';
+
+    *out++ = ' ';
+
+    if (enPassantSquare.isValid())
+    {
+        *out++ = static_cast<char>('a' + enPassantSquare.col());
+        *out++ = static_cast<char>('1' + enPassantSquare.row());
+    }
+    else
+    {
+        *out++ = '-';
+    }
+
+    *out++ = ' ';
+    out = std::to_chars(out, buffer + MAX_FEN_LENGTH, halfmove).ptr;
+    *out++ = ' ';
+    out = std::to_chars(out, buffer + MAX_FEN_LENGTH, moveNumber).ptr;
+    *out = '\0';
+
+    return static_cast<int>(out - buffer);
+}
+
+/*
+    Returns fen representation of the position
+*/
+std::string Board::fen() const
+{
+    char buffer[MAX_FEN_LENGTH];
+    const int length = fen(buffer);
+
+    return std::string(buffer, length);
+}
+
+/*
+ *   Store the packed representation of the position, the undo stack is not stored.
+ *   Return false and leave packed unchanged if the position has more than 32 pieces,
+ *   the loadFen without validation accepts them
+ */
+bool Board::pack(PackedBoard &packed) const
+{
+    uint64_t occupancy = AllPiecesBB;
+    int pieceIndex = 0;
+
+    if (std::popcount(occupancy) > 32)
+    {
+        return false;
+    }
+
+    packed = PackedBoard{};
+    packed.occupancy = occupancy;
+
+    while (occupancy != 0)
+    {
+        const Square square = std::countr_zero(occupancy);
+        occupancy &= (occupancy - 1);
+
+        packed.pieces[pieceIndex / 2] |= static_cast<uint8_t>(index(getPiece(square)) << (4 * (pieceIndex % 2)));
+        pieceIndex++;
     }
 
-    fen << (sideToMove == Color::WHITE ? " w " : " b ");
+    packed.state = (sideToMove == Color::BLACK ? 1 : 0) | (getCastleRights() << 1);
+    packed.enPassant = enPassantSquare.isValid() ? enPassantSquare.value() : 255;
+    packed.halfmove = static_cast<uint16_t>(halfmove);
+    packed.moveNumber = static_cast<uint16_t>(moveNumber);
 
-    if (castleKWhite)
-        fen << 'K';
-    if (castleQWhite)
-        fen << 'Q';
-    if (castleKBlack)
-        fen << 'k';
-    if (castleQBlack)
-        fen << 'q';
+    return true;
+}
 
-    if (!castleKWhite && !castleQWhite && !castleKBlack && !castleQBlack)
+/*
+ *   Set the position stored in the packed representation, the undo stack is cleared
+ */
+void Board::unpack(const PackedBoard &packed)
+{
+    clearPosition();
+
+    uint64_t occupancy = packed.occupancy;
+    int pieceIndex = 0;
+
+    while (occupancy != 0)
     {
-        fen << '-';
+        const Square square = std::countr_zero(occupancy);
+        occupancy &= (occupancy - 1);
+
+        putPiece(static_cast<Piece>((packed.pieces[pieceIndex / 2] >> (4 * (pieceIndex % 2))) & 0xF), square);
+        pieceIndex++;
     }
 
-    fen << (!enPassantSquare.isValid() ? " - " : " " + enPassantSquare.toString() + " ")
-        << halfmove << " " << moveNumber;
+    sideToMove = (packed.state & 1) ? Color::BLACK : Color::WHITE;
+    setCastleRights((packed.state >> 1) & 0xF);
+
+    if (packed.enPassant < 64)
+        enPassantSquare = Square(packed.enPassant);
+    else
+        enPassantSquare.setInvalid();
 
-    return fen.str();
+    halfmove = packed.halfmove;
+    moveNumber = packed.moveNumber;
+    historyPly = 0;
+
+    zobristKey = computeZobristKey();
 }
 
 /*
@@ -171,34 +428,24 @@ std::string Board::fen() const
  */
 void Board::checkAndModifyCastleRights()
 {
+    const bool whiteKing = getPiece({ROW_1, COL_E}) == Piece::WKing;
+    const bool blackKing = getPiece({ROW_8, COL_E}) == Piece::BKing;
 
     // Check for white king-side castling rights
-    if (castleKWhite)
-    {
+    if (!whiteKing || getPiece({ROW_1, COL_H}) != Piece::WRook)
+        castleRights &= ~WHITE_KING_CASTLE;
 
-        castleKWhite = getPiece({ROW_1, COL_E}) == Piece::WKing &&
-                       getPiece({ROW_1, COL_H}) == Piece::WRook;
-    }
     // Check for white queen-side castling rights
-    if (castleQWhite)
-    {
-        castleQWhite = getPiece({ROW_1, COL_E}) == Piece::WKing &&
-                       getPiece({ROW_1, COL_A}) == Piece::WRook;
-    }
+    if (!whiteKing || getPiece({ROW_1, COL_A}) != Piece::WRook)
+        castleRights &= ~WHITE_QUEEN_CASTLE;
 
     // Check for black king-side castling rights
-    if (castleKBlack)
-    {
-        castleKBlack = getPiece({ROW_8, COL_E}) == Piece::BKing &&
-                       getPiece({ROW_8, COL_H}) == Piece::BRook;
-    }
+    if (!blackKing || getPiece({ROW_8, COL_H}) != Piece::BRook)
+        castleRights &= ~BLACK_KING_CASTLE;
 
     // Check for black queen-side castling rights
-    if (castleQBlack)
-    {
-        castleQBlack = getPiece({ROW_8, COL_E}) == Piece::BKing &&
-                       getPiece({ROW_8, COL_A}) == Piece::BRook;
-    }
+    if (!blackKing || getPiece({ROW_8, COL_A}) != Piece::BRook)
+        castleRights &= ~BLACK_QUEEN_CASTLE;
 }
 
 /*
@@ -221,7 +468,8 @@ void Board::checkAndModifyEnPassantRule()
         if (enPassantSquare.row() == ROW_6)
         {
 
-            if ((getPiece({ROW_5, col - 1}) == Piece::WPawn || getPiece({ROW_5, col + 1}) == Piece::WPawn) &&
+            if (((col > COL_A && getPiece({ROW_5, col - 1}) == Piece::WPawn) ||
+                 (col < COL_H && getPiece({ROW_5, col + 1}) == Piece::WPawn)) &&
                 getPiece({ROW_5, col}) == Piece::BPawn &&
                 empty(enPassantSquare) && empty({ROW_7, col}))
             {
@@ -230,8 +478,9 @@ void Board::checkAndModifyEnPassantRule()
         }
         else if (enPassantSquare.row() == ROW_3)
         {
-            if ((getPiece({ROW_4, col - 1}) == Piece::BPawn || getPiece({ROW_4, col + 1}) == Piece::BPawn) &&
-                getPiece({ROW_5, col}) == Piece::WPawn &&
+            if (((col > COL_A && getPiece({ROW_4, col - 1}) == Piece::BPawn) ||
+                 (col < COL_H && getPiece({ROW_4, col + 1}) == Piece::BPawn)) &&
+                getPiece({ROW_4, col}) == Piece::WPawn &&
                 empty(enPassantSquare) && empty({ROW_2, col}))
             {
                 valid = true;
@@ -247,6 +496,26 @@ void Board::checkAndModifyEnPassantRule()
 }
 
 /*
+ *   Castle rights kept when a piece moves from or to each square,
+ *   only the king and rook initial squares remove rights
+ */
+static constexpr auto castleRightsMask = []
+{
+    std::array<uint8_t, 64> mask{};
+    mask.fill(ALL_CASTLES);
+
+    mask[SQ_E1] = ALL_CASTLES & ~(WHITE_KING_CASTLE | WHITE_QUEEN_CASTLE);
+    mask[SQ_H1] = ALL_CASTLES & ~WHITE_KING_CASTLE;
+    mask[SQ_A1] = ALL_CASTLES & ~WHITE_QUEEN_CASTLE;
+    mask[SQ_E8] = ALL_CASTLES & ~(BLACK_KING_CASTLE | BLACK_QUEEN_CASTLE);
+    mask[SQ_H8] = ALL_CASTLES & ~BLACK_KING_CASTLE;
+    mask[SQ_A8] = ALL_CASTLES & ~BLACK_QUEEN_CASTLE;
+
+    return mask;
+}();
+
+/*
+ *   Play the move on the board and update the game state.
  *   Throw runtime error "Invalid move"
  */
 void Board::makeMove(Move move)
@@ -258,10 +527,54 @@ void Board::makeMove(Move move)
         throw std::runtime_error("Invalid move");
     }
 
+    assert(historyPly < MAX_HISTORY_PLY);
+
+    const Square from = move.squareFrom();
+    const Square to = move.squareTo();
+    const bool isPawnMove = getPieceType(from) == PieceType::PAWN;
+    const bool isCapture = !empty(to) || moveType == MoveType::EN_PASSANT;
+
+    dirtyPieces.count = 0;
+
+    // save the state that the move can not restore
+    StateInfo &state = history[historyPly++];
+    state.zobristKey = zobristKey;
+    state.enPassantSquare = enPassantSquare;
+    state.castleRights = castleRights;
+    state.halfmove = halfmove;
+
+    if (moveType == MoveType::EN_PASSANT)
+    {
+        state.capturedPiece = sideToMove == Color::WHITE ? Piece::BPawn : Piece::WPawn;
+    }
+    else
+    {
+        // castle always moves to an empty square
+        state.capturedPiece = getPiece(to);
+    }
+
+    // en passant is only available right after the double push
+    if (enPassantSquare.isValid())
+    {
+        zobristKey ^= zobrist.getEnPassantKey(enPassantSquare);
+        enPassantSquare.setInvalid();
+    }
+
     if (moveType == MoveType::NORMAL)
     {
-        putPiece(getPiece(move.squareFrom()), move.squareTo());
-        deletePiece(move.squareFrom());
+        putPiece(getPiece(from), to);
+        deletePiece(from);
+
+        if (isPawnMove && (to - from == 16 || from - to == 16))
+        {
+            enPassantSquare = Square((from + to) / 2);
+            checkAndModifyEnPassantRule();
+
+            if (enPassantSquare.isValid())
+            {
+                zobristKey ^= zobrist.getEnPassantKey(enPassantSquare);
+            }
+        }
     }
     else if (moveType == MoveType::CASTLING)
     {
@@ -273,16 +586,32 @@ void Board::makeMove(Move move)
     }
     else if (moveType == MoveType::PROMOTION)
     {
-        Piece promotionPiece = createPieceByTypeAndColor(move.promotionPiece(), getPieceColor(move.squareFrom()));
-        putPiece(promotionPiece, move.squareTo());
-        deletePiece(move.squareFrom());
+        Piece promotionPiece = createPieceByTypeAndColor(move.promotionPiece(), getPieceColor(from));
+        putPiece(promotionPiece, to);
+        deletePiece(from);
+    }
+
+    // moving from or to a king or rook initial square loses castle rights
+    castleRights &= castleRightsMask[from] & castleRightsMask[to];
+    zobristKey ^= zobrist.getCastleKey(state.castleRights) ^ zobrist.getCastleKey(castleRights);
+
+    halfmove = (isPawnMove || isCapture) ? 0 : halfmove + 1;
+
+    if (sideToMove == Color::BLACK)
+    {
+        moveNumber++;
     }
+
+    sideToMove = sideToMove == Color::WHITE ? Color::BLACK : Color::WHITE;
+    zobristKey ^= zobrist.getSideKey();
+
+    assert(zobristKey == computeZobristKey());
 }
 
 void Board::makeCastle(Move move)
 {
     /*
-     * squareTo() should be the king origin and squareFrom() is the king end square
+     * squareFrom() should be the king origin and squareTo() is the king end square
      */
 
     deletePiece(move.squareFrom());
@@ -327,4 +656,233 @@ void Board::makeEnPassant(Move move)
         putPiece(Piece::WPawn, move.squareTo());
         deletePiece(move.squareTo() + Dir::DOWN);
     }
-}
\ No newline at end of file
+}
+/*
+ *   Remove the undo stack entries that can not be repeated anymore, the ones before the
+ *   last capture or pawn move, keeping at most the 100 plies of the fifty moves rule.
+ *   Used by long games, the removed moves can not be undone.
+ */
+void Board::trimHistory()
+{
+    const int keep = std::min({static_cast<int>(halfmove), 100, historyPly});
+
+    std::memmove(history, history + historyPly - keep, keep * sizeof(StateInfo));
+    historyPly = keep;
+}
+
+/*
+ *   Undo the move, it should be the last move made on the board
+ */
+void Board::unmakeMove(Move move)
+{
+    assert(historyPly > 0);
+
+    const StateInfo &state = history[--historyPly];
+    const MoveType moveType = move.type();
+
+    dirtyPieces.count = 0;
+    const Square from = move.squareFrom();
+    const Square to = move.squareTo();
+
+    sideToMove = sideToMove == Color::WHITE ? Color::BLACK : Color::WHITE;
+
+    if (sideToMove == Color::BLACK)
+    {
+        moveNumber--;
+    }
+
+    if (moveType == MoveType::NORMAL)
+    {
+        putPiece(getPiece(to), from);
+        deletePiece(to);
+    }
+    else if (moveType == MoveType::CASTLING)
+    {
+        unmakeCastle(move);
+    }
+    else if (moveType == MoveType::EN_PASSANT)
+    {
+        unmakeEnPassant(move);
+    }
+    else if (moveType == MoveType::PROMOTION)
+    {
+        putPiece(createPieceByTypeAndColor(PieceType::PAWN, sideToMove), from);
+        deletePiece(to);
+    }
+
+    if (moveType != MoveType::EN_PASSANT && state.capturedPiece != Piece::Empty)
+    {
+        putPiece(state.capturedPiece, to);
+    }
+
+    enPassantSquare = state.enPassantSquare;
+    setCastleRights(state.castleRights);
+    halfmove = state.halfmove;
+    zobristKey = state.zobristKey;
+}
+
+void Board::unmakeCastle(Move move)
+{
+    deletePiece(move.squareTo());
+
+    if (move.squareTo() == SQ_G1)
+    {
+        putPiece(Piece::WKing, SQ_E1);
+        deletePiece(SQ_F1);
+        putPiece(Piece::WRook, SQ_H1);
+    }
+    else if (move.squareTo() == SQ_C1)
+    {
+        putPiece(Piece::WKing, SQ_E1);
+        deletePiece(SQ_D1);
+        putPiece(Piece::WRook, SQ_A1);
+    }
+    else if (move.squareTo() == SQ_G8)
+    {
+        putPiece(Piece::BKing, SQ_E8);
+        deletePiece(SQ_F8);
+        putPiece(Piece::BRook, SQ_H8);
+    }
+    else if (move.squareTo() == SQ_C8)
+    {
+        putPiece(Piece::BKing, SQ_E8);
+        deletePiece(SQ_D8);
+        putPiece(Piece::BRook, SQ_A8);
+    }
+}
+
+void Board::unmakeEnPassant(Move move)
+{
+    deletePiece(move.squareTo());
+
+    if (move.squareTo().row() == ROW_3)
+    {
+        putPiece(Piece::BPawn, move.squareFrom());
+        putPiece(Piece::WPawn, move.squareTo() + Dir::UP);
+    }
+    else if (move.squareTo().row() == ROW_6)
+    {
+        putPiece(Piece::WPawn, move.squareFrom());
+        putPiece(Piece::BPawn, move.squareTo() + Dir::DOWN);
+    }
+}
+
+uint64_t Board::attackersTo(Square square, uint64_t occupancy) const
+{
+    const uint64_t bishopsQueens = bitBoards[index(Piece::WBishop)] | bitBoards[index(Piece::BBishop)] |
+                                   bitBoards[index(Piece::WQueen)] | bitBoards[index(Piece::BQueen)];
+    const uint64_t rooksQueens = bitBoards[index(Piece::WRook)] | bitBoards[index(Piece::BRook)] |
+                                 bitBoards[index(Piece::WQueen)] | bitBoards[index(Piece::BQueen)];
+
+    // a pawn attacks the square if a pawn of the other color in the square would attack it
+    return (precomputedData.getPawnBlackAttacks(square) & bitBoards[index(Piece::WPawn)]) |
+           (precomputedData.getPawnWhiteAttacks(square) & bitBoards[index(Piece::BPawn)]) |
+           (precomputedData.getKnightAttacks(square) & (bitBoards[index(Piece::WKnight)] | bitBoards[index(Piece::BKnight)])) |
+           (precomputedData.getKingAttacks(square) & (bitBoards[index(Piece::WKing)] | bitBoards[index(Piece::BKing)])) |
+           (precomputedData.getBishopMoves(square, occupancy) & bishopsQueens) |
+           (precomputedData.getRookMoves(square, occupancy) & rooksQueens);
+}
+
+/*
+ *   Swap algorithm https://www.chessprogramming.org/SEE_-_The_Swap_Algorithm
+ *
+ *   The sides capture on the square with their least valuable attacker until one of them
+ *   stops because the capture would leave the balance below the threshold. The captured
+ *   pieces are removed from the occupancy, so the sliders behind them (x-rays) join the
+ *   exchange. The board is not modified and the pins are not taken into account.
+ */
+bool Board::see(Move move, int threshold) const
+{
+    // castling does not exchange material, en passant and promotions are only compared with the threshold
+    if (move.type() != MoveType::NORMAL)
+    {
+        return threshold <= 0;
+    }
+
+    const Square from = move.squareFrom();
+    const Square to = move.squareTo();
+
+    // balance if the opponent does not recapture
+    int swap = pieceValue[static_cast<int>(getPieceType(to))] - threshold;
+
+    if (swap < 0)
+    {
+        return false;
+    }
+
+    // balance for the opponent if it recaptures the moved piece and the exchange ends
+    swap = pieceValue[static_cast<int>(getPieceType(from))] - swap;
+
+    if (swap <= 0)
+    {
+        return true;
+    }
+
+    const uint64_t bishopsQueens = bitBoards[index(Piece::WBishop)] | bitBoards[index(Piece::BBishop)] |
+                                   bitBoards[index(Piece::WQueen)] | bitBoards[index(Piece::BQueen)];
+    const uint64_t rooksQueens = bitBoards[index(Piece::WRook)] | bitBoards[index(Piece::BRook)] |
+                                 bitBoards[index(Piece::WQueen)] | bitBoards[index(Piece::BQueen)];
+
+    uint64_t occupancy = AllPiecesBB ^ from.mask() ^ to.mask();
+    uint64_t attackers = attackersTo(to, occupancy);
+    Color side = getPieceColor(from);
+
+    // true while the side of the move reaches the threshold
+    bool result = true;
+
+    while (true)
+    {
+        side = side == Color::WHITE ? Color::BLACK : Color::WHITE;
+        attackers &= occupancy;
+
+        const uint64_t sideAttackers = attackers & friendlyBB(side);
+
+        if (sideAttackers == 0)
+        {
+            break;
+        }
+
+        result = !result;
+
+        const int offset = side == Color::WHITE ? 0 : 6;
+        int type = static_cast<int>(PieceType::PAWN);
+        uint64_t bitboard = 0;
+
+        // least valuable attacker
+        for (; type < static_cast<int>(PieceType::KING); type++)
+        {
+            if ((bitboard = sideAttackers & bitBoards[type + offset]))
+            {
+                break;
+            }
+        }
+
+        // the king only captures if the opponent has no attackers left
+        if (type == static_cast<int>(PieceType::KING))
+        {
+            return (attackers & ~friendlyBB(side)) ? !result : result;
+        }
+
+        swap = pieceValue[type] - swap;
+
+        if (swap < static_cast<int>(result))
+        {
+            break;
+        }
+
+        occupancy ^= bitboard & -bitboard;
+
+        // only the sliders in the line of the removed piece can be discovered
+        if (type != static_cast<int>(PieceType::ROOK) && type != static_cast<int>(PieceType::KNIGHT))
+        {
+            attackers |= precomputedData.getBishopMoves(to, occupancy) & bishopsQueens;
+        }
+
+        if (type == static_cast<int>(PieceType::ROOK) || type == static_cast<int>(PieceType::QUEEN))
+        {
+            attackers |= precomputedData.getRookMoves(to, occupancy) & rooksQueens;
+        }
+    }
+
+    return result;
+}
@@ -1,24 +1,113 @@
 #pragma once
 
+#include <cstddef>
+#include <string_view>
+
 #include "move.hpp"
+#include "packedBoard.hpp"
+#include "pieceSquareTable.hpp"
+#include "zobrist.hpp"
+
+/*
+ *   max number of moves that can be undone, plies stored in the undo stack
+ */
+#define MAX_HISTORY_PLY 1024
+
+// well known positions, used for testing and benchmarking
+constexpr auto StartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+constexpr auto EnPassantFEN = "rnbqkb1r/2pp2pn/1p6/pP1PppPp/8/2N5/P1P1PP1P/R1BQKBNR w KQkq f6 0 8";
+constexpr auto PromotionFEN = "r3kb1r/pbpqn1P1/1pn4p/5Q2/2P5/2N5/PP1BN1pP/R3KB1R w KQkq - 2 13";
+constexpr auto KiwipeteFEN = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+
+/*
+ *   max length of a fen string written by Board::fen(char *), including the null character
+ *   64 pieces + 7 '/' + side, castle, en passant and the two clocks
+ */
+#define MAX_FEN_LENGTH 128
+
+/*
+ *   Errors reported by Board::loadFen in validation mode
+ */
+enum class FenError : uint8_t
+{
+    NONE,
+    PIECE_PLACEMENT,
+    SIDE_TO_MOVE,
+    CASTLING,
+    EN_PASSANT,
+    HALFMOVE,
+    FULLMOVE,
+    KINGS,
+    PAWNS,
+    TRAILING_CHARACTERS
+};
+
+std::string_view fenErrorToString(FenError error);
+
+/*
+ *   Game state that can not be recovered from the move when it is undone,
+ *   stored in the undo stack before making each move.
+ *
+ *   castleRights bits : CastleRights mask of Board::castleRights
+ */
+struct StateInfo
+{
+    uint64_t zobristKey;
+    Piece capturedPiece;
+    Square enPassantSquare;
+    uint8_t castleRights;
+    uint16_t halfmove;
+};
+
+/*
+ *   Piece added to or removed from a square by putPiece or deletePiece
+ */
+struct DirtyPiece
+{
+    Piece piece;
+    Square square;
+    bool added;
+};
+
+// max changes recorded for one move, should be a power of 2, a move makes at most 4
+#define MAX_DIRTY_PIECES 8
+
+/*
+ *   Piece changes of the last move made or undone, used to update the
+ *   neural network accumulators without scanning the board
+ */
+struct DirtyPieces
+{
+    DirtyPiece pieces[MAX_DIRTY_PIECES];
+    uint8_t count;
+};
 
 class Board
 {
 
 public:
-    Board() { clearPosition(); }
+    Board() : historyPly(0) { clearPosition(); }
     ~Board() {}
 
     std::string toString() const;
 
-    void loadFen(const std::string &fen);
+    FenError loadFen(std::string_view fen, bool validate = false);
+    int fen(char *buffer) const;
     std::string fen() const;
 
+    // lossless conversion to and from the 32 bytes representation, false if the position has more than 32 pieces
+    bool pack(PackedBoard &packed) const;
+    void unpack(const PackedBoard &packed);
+
     bool empty(Square square) const;
     void makeMove(Move move);
+    void unmakeMove(Move move);
 
-    // board with the pieces
-    Piece boardPieces[64];
+    // pieces of both colors that attack the square, the sliders are blocked by the occupancy
+    uint64_t attackersTo(Square square, uint64_t occupancy) const;
+
+    // static exchange evaluation, true if the exchanges on the square of the move win at least threshold
+    bool see(Move move, int threshold) const;
 
     /*
         index of each bitboard
@@ -35,26 +124,44 @@ public:
         BRook = 9
         BQueen = 10
         BKing = 11
+
+        The bitboards and keys fill the first 2 cache lines and the pieces the 3rd one,
+        the game state starts the 4th cache line
     */
-    uint64_t bitBoards[11];
+    alignas(64) uint64_t bitBoards[12];
 
     uint64_t BlackBB;     // bitboard for black pieces
     uint64_t WhiteBB;     // bitboard for white pieces
     uint64_t AllPiecesBB; // bitboard for all pieces
 
-    uint64_t pinMask;
-    uint64_t checkMask;
+    // zobrist key of the position, updated incrementally
+    uint64_t zobristKey;
+
+    // board with the pieces
+    alignas(64) Piece boardPieces[64];
 
     // Game state
 
     Color sideToMove;
-    bool castleKWhite;
-    bool castleQWhite;
-    bool castleKBlack;
-    bool castleQBlack;
+    uint8_t castleRights; // CastleRights bits
     Square enPassantSquare;
-    int halfmove;
-    int moveNumber;
+    uint16_t halfmove;
+    uint16_t moveNumber;
+
+    // zobrist key of the pawns of both colors, updated incrementally, used by the pawn table
+    uint64_t pawnKey;
+
+    // material and piece-square sums from the white point of view and game phase, updated incrementally
+    int16_t mgScore;
+    int16_t egScore;
+    uint8_t gamePhase;
+
+    // pieces changed by the last makeMove or unmakeMove
+    DirtyPieces dirtyPieces;
+
+    // undo stack, one entry for each move made and not undone
+    StateInfo history[MAX_HISTORY_PLY];
+    int historyPly;
 
     Piece getPiece(Square square) const;
     PieceType getPieceType(Square square) const;
@@ -62,6 +169,7 @@ public:
     char squareToChar(Square square) const;
     void putPiece(Piece piece, Square square);
     void deletePiece(Square square);
+    void addDirtyPiece(Piece piece, Square square, bool added);
     uint64_t friendlyBB(Color color) const;
     uint64_t enemyBB(Color color) const;
     uint64_t enemyOrEmptyBB(Color color) const;
@@ -71,8 +179,18 @@ public:
 
     void makeCastle(Move move);
     void makeEnPassant(Move move);
+    void unmakeCastle(Move move);
+    void unmakeEnPassant(Move move);
+    uint8_t getCastleRights() const;
+    void setCastleRights(uint8_t castleRights);
+    uint64_t computeZobristKey() const;
+    bool isRepetition() const;
+    void trimHistory();
 };
 
+static_assert(offsetof(Board, boardPieces) == 128, "the bitboards and keys should fill 2 cache lines");
+static_assert(offsetof(Board, sideToMove) == 192, "the game state should start the 4th cache line");
+
 /*
  *   Returns the piece in the square, if square should be valid
  */
@@ -118,6 +236,15 @@ inline bool Board::empty(Square square) const
     return boardPieces[square] == Piece::Empty;
 }
 
+/*
+ *   Record the change, loading a position puts more pieces than the buffer has,
+ *   the index wraps around and the changes are not used until the next move
+ */
+inline void Board::addDirtyPiece(Piece piece, Square square, bool added)
+{
+    dirtyPieces.pieces[dirtyPieces.count++ & (MAX_DIRTY_PIECES - 1)] = {piece, square, added};
+}
+
 /*
  *   Input should be a valid square && piece != Empty;
  */
@@ -133,9 +260,26 @@ inline void Board::putPiece(Piece piece, Square square)
         bitBoards[index(getPiece(square))] &= ~mask;
         WhiteBB &= ~mask;
         BlackBB &= ~mask;
+        zobristKey ^= zobrist.getPieceKey(getPiece(square), square);
+        mgScore -= pieceSquareTable.getMg(getPiece(square), square);
+        egScore -= pieceSquareTable.getEg(getPiece(square), square);
+        gamePhase -= pieceSquareTable.getPhase(getPiece(square));
+        addDirtyPiece(getPiece(square), square, false);
+
+        if (pieceToPieceType(getPiece(square)) == PieceType::PAWN)
+            pawnKey ^= zobrist.getPieceKey(getPiece(square), square);
     }
 
     bitBoards[newPieceIndex] |= mask;
+    zobristKey ^= zobrist.getPieceKey(piece, square);
+    mgScore += pieceSquareTable.getMg(piece, square);
+    egScore += pieceSquareTable.getEg(piece, square);
+    gamePhase += pieceSquareTable.getPhase(piece);
+    addDirtyPiece(piece, square, true);
+
+    if (pieceToPieceType(piece) == PieceType::PAWN)
+        pawnKey ^= zobrist.getPieceKey(piece, square);
+
     boardPieces[square] = piece;
 
     if (color(piece) == Color::WHITE)
@@ -156,6 +300,15 @@ inline void Board::putPiece(Piece piece, Square square)
 inline void Board::deletePiece(Square square)
 {
     uint64_t mask = square.mask();
+    zobristKey ^= zobrist.getPieceKey(getPiece(square), square);
+    mgScore -= pieceSquareTable.getMg(getPiece(square), square);
+    egScore -= pieceSquareTable.getEg(getPiece(square), square);
+    gamePhase -= pieceSquareTable.getPhase(getPiece(square));
+    addDirtyPiece(getPiece(square), square, false);
+
+    if (pieceToPieceType(getPiece(square)) == PieceType::PAWN)
+        pawnKey ^= zobrist.getPieceKey(getPiece(square), square);
+
     bitBoards[index(getPiece(square))] &= ~mask;
     WhiteBB &= ~mask;
     BlackBB &= ~mask;
@@ -163,15 +316,37 @@ inline void Board::deletePiece(Square square)
     AllPiecesBB = WhiteBB | BlackBB;
 }
 
+/*
+ *   Return the castle rights packed in 4 bits, as stored in StateInfo
+ */
+inline uint8_t Board::getCastleRights() const
+{
+    return castleRights;
+}
+
+/*
+ *   Set the castle rights from the 4 bits packed by getCastleRights()
+ */
+inline void Board::setCastleRights(uint8_t castleRights)
+{
+    this->castleRights = castleRights & ALL_CASTLES;
+}
+
 /*
  *   Remove all pieces on the board
- *   Do not modify the game state, just put all bitboards = 0
+ *   Do not modify the game state, just put all bitboards, the zobrist keys and the evaluation sums = 0
  */
 inline void Board::clearPosition()
 {
     BlackBB = 0;
     WhiteBB = 0;
     AllPiecesBB = 0;
+    zobristKey = 0;
+    pawnKey = 0;
+    mgScore = 0;
+    egScore = 0;
+    gamePhase = 0;
+    dirtyPieces.count = 0;
 
     for (int i = 0; i < 12; i++)
         bitBoards[i] = 0;
@@ -196,6 +371,25 @@ inline uint64_t Board::enemyBB(Color color) const
     return color == Color::WHITE ? BlackBB : WhiteBB;
 }
 
+/*
+ *   Return true if the position appeared before, since the last capture or pawn move.
+ *   Only the positions with the same side to move are compared
+ */
+inline bool Board::isRepetition() const
+{
+    const int first = historyPly - halfmove > 0 ? historyPly - halfmove : 0;
+
+    for (int ply = historyPly - 4; ply >= first; ply -= 2)
+    {
+        if (history[ply].zobristKey == zobristKey)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /*
  * Return the bitboard of all the squares empty or with an enemy piece
  */
@@ -1,5 +1,14 @@
 #pragma once
 
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#ifdef USE_AVX2_PICK
+#include <immintrin.h>
+#endif
+
 #include "types.hpp"
 #include "square.hpp"
 
@@ -83,6 +92,9 @@ public:
         return static_cast<PieceType>(((data & 0b0011'0000'0000'0000) >> 12) + 1);
     }
 
+    // return the 16 bits of the move, used to store the move in tables
+    constexpr inline std::uint16_t raw() const { return data; }
+
     // move is not null and is not none
     constexpr bool isValid() const { return none().data != data && null().data != data; }
 
@@ -125,13 +137,26 @@ private:
     std::uint16_t data;
 };
 
+/*
+ *   Move with its ordering score, the scores fit in 32 bits (history, captures and evasion bonus).
+ *   The score is first so the scores of 4 moves can be loaded in a 256 bits register.
+ *   The move is stored raw so the lists are not initialized when they are created
+ */
+struct ScoredMove
+{
+    int32_t score;
+    uint16_t move;
+};
+
+static_assert(sizeof(ScoredMove) == 8 && offsetof(ScoredMove, score) == 0, "the moves are scanned in blocks of 8 bytes");
+
 class MoveList
 {
 public:
     MoveList() : nMoves(0) {}
 
     // store a move in the list
-    constexpr inline void add(Move move) { moves[nMoves++] = move; }
+    constexpr inline void add(Move move) { moves[nMoves++].move = move.raw(); }
 
     // empty the list
     constexpr inline void clear() { nMoves = 0; }
@@ -140,7 +165,27 @@ public:
     constexpr inline int size() const { return nMoves; }
 
     // return the move in the pos index, index should be valid ( 0 <= index< nMoves)
-    constexpr inline Move get(int index) const { return moves[index]; }
+    constexpr inline Move get(int index) const { return Move(moves[index].move); }
+
+    // return the score of the move in the pos index, index should be valid ( 0 <= index< nMoves)
+    constexpr inline int getScore(int index) const { return moves[index].score; }
+
+    // set the score of the move in the pos index, index should be valid ( 0 <= index< nMoves)
+    constexpr inline void setScore(int index, int score) { moves[index].score = score; }
+
+    /*
+     *   Selection sort step, swap the move with the best score from the index to the end of
+     *   the list to the index and return it, with equal scores the first one is picked.
+     *   Each pick costs O(n) and after a beta cutoff the rest of the list is never sorted.
+     */
+    inline Move pickBest(int index)
+    {
+        const int best = bestIndex(index);
+
+        std::swap(moves[index], moves[best]);
+
+        return Move(moves[index].move);
+    }
 
     /*
      *   Return string representation of all moves in the list E.g :
@@ -152,12 +197,77 @@ public:
         std::string s = "";
         for (int i = 0; i < nMoves; i++)
         {
-            s += moves[i].toString() + ":\n";
+            s += Move(moves[i].move).toString() + ":\n";
         }
         return s;
     }
 
 private:
-    Move moves[MAX_MOVES];
+    ScoredMove moves[MAX_MOVES];
     int nMoves;
-};
\ No newline at end of file
+
+    // index of the first move with the best score from the index to the end of the list
+    inline int bestIndex(int index) const;
+};
+
+#ifdef USE_AVX2_PICK
+
+/*
+ *   Find the best score 4 moves at a time, the moves are in the odd 32 bits lanes
+ *   and they are replaced by the minimum score, then find the first move with that score
+ */
+inline int MoveList::bestIndex(int index) const
+{
+    int i = index;
+    int bestScore = INT_MIN;
+
+    if (nMoves - index >= 8)
+    {
+        const __m256i minimum = _mm256_set1_epi32(INT_MIN);
+        __m256i scores = minimum;
+
+        for (; i + 4 <= nMoves; i += 4)
+        {
+            const __m256i entries = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(moves + i));
+            scores = _mm256_max_epi32(scores, _mm256_blend_epi32(entries, minimum, 0b10101010));
+        }
+
+        __m128i max = _mm_max_epi32(_mm256_castsi256_si128(scores), _mm256_extracti128_si256(scores, 1));
+        max = _mm_max_epi32(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(1, 0, 3, 2)));
+        max = _mm_max_epi32(max, _mm_shuffle_epi32(max, _MM_SHUFFLE(2, 3, 0, 1)));
+        bestScore = _mm_cvtsi128_si32(max);
+    }
+
+    for (; i < nMoves; i++)
+    {
+        bestScore = moves[i].score > bestScore ? moves[i].score : bestScore;
+    }
+
+    int best = index;
+
+    while (moves[best].score != bestScore)
+    {
+        best++;
+    }
+
+    return best;
+}
+
+#else
+
+inline int MoveList::bestIndex(int index) const
+{
+    int best = index;
+
+    for (int i = index + 1; i < nMoves; i++)
+    {
+        if (moves[i].score > moves[best].score)
+        {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+/*
+ *   Canonical 32 bytes representation of a position, used to store positions
+ *   in memory or on disk (position sets, repetition history, training data).
+ *
+ *   occupancy : bit i set if the square i has a piece
+ *   pieces    : 4 bits piece code (Piece enum) of each occupied square, in square order,
+ *               the piece of the n-th occupied square is in the nibble n (low nibble first)
+ *   state     : bit 0 side to move (1 = black), bits 1-4 castle rights (Board::getCastleRights())
+ *   enPassant : en passant square, 255 if there is none
+ *
+ *   The unused nibbles and the reserved bytes are always 0, so two positions
+ *   are equal if and only if the 32 bytes are equal.
+ *   A legal position has at most 32 pieces, Board::pack() rejects the positions with more.
+ */
+struct alignas(32) PackedBoard
+{
+    uint64_t occupancy;
+    uint8_t pieces[16];
+    uint8_t state;
+    uint8_t enPassant;
+    uint16_t halfmove;
+    uint16_t moveNumber;
+    uint16_t reserved;
+
+    // compare the 4 words without branches, the compiler uses vector compares
+    inline bool operator==(const PackedBoard &other) const
+    {
+        uint64_t a[4], b[4];
+        std::memcpy(a, this, sizeof(a));
+        std::memcpy(b, &other, sizeof(b));
+
+        return ((a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3])) == 0;
+    }
+
+    inline bool operator!=(const PackedBoard &other) const { return !(*this == other); }
+
+    // mix of the 4 words, not related with the zobrist key of the position
+    inline uint64_t hash() const
+    {
+        uint64_t words[4];
+        std::memcpy(words, this, sizeof(words));
+
+        uint64_t h = 0x9E3779B97F4A7C15ULL;
+
+        for (uint64_t word : words)
+        {
+            h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+            h ^= h >> 31;
+        }
+
+        return h;
+    }
+};
+
+static_assert(sizeof(PackedBoard) == 32, "PackedBoard should be 32 bytes");
+
+template <>
+struct std::hash<PackedBoard>
+{
+    inline std::size_t operator()(const PackedBoard &packed) const { return packed.hash(); }
+};
@@ -71,7 +71,7 @@ enum Dir : int
     The order is important and used to store promotion piece in move
     and to convert PieceType and color into Piece
 */
-enum class PieceType
+enum class PieceType : uint8_t
 {
     PAWN = 0,
     KNIGHT = 1,
@@ -99,7 +99,7 @@ enum class PieceType
 
     The order is important and used to access bitboards
 */
-enum class Piece
+enum class Piece : uint8_t
 {
     WPawn = 0,
     WKnight = 1,
@@ -116,6 +116,19 @@ enum class Piece
     Empty = 12
 };
 
+/*
+ *   Bits of the 4 bit castle rights mask
+ */
+enum CastleRights : uint8_t
+{
+    NO_CASTLE = 0,
+    WHITE_KING_CASTLE = 1,
+    WHITE_QUEEN_CASTLE = 2,
+    BLACK_KING_CASTLE = 4,
+    BLACK_QUEEN_CASTLE = 8,
+    ALL_CASTLES = 15
+};
+
 constexpr inline int index(Piece piece)
 {
     return static_cast<int>(piece);
@@ -125,7 +138,7 @@ constexpr inline int index(Piece piece)
  *   White = 0
  *   Black = 1
  */
-enum class Color
+enum class Color : uint8_t
 {
     WHITE = 0,
     BLACK = 1
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+
+#include "types.hpp"
+#include "square.hpp"
+
+/*
+ *   Random keys used to hash the position, the key of a position is the xor
+ *   of the keys of each piece in its square, the side to move, the castle rights
+ *   and the en passant column.
+ *
+ *   https://www.chessprogramming.org/Zobrist_Hashing
+ */
+class Zobrist
+{
+public:
+    constexpr Zobrist() : pieceKeys{}, castleKeys{}, enPassantKeys{}, sideKey(0)
+    {
+        uint64_t seed = 0x9E3779B97F4A7C15ULL;
+
+        for (int piece = 0; piece < 12; piece++)
+            for (int square = 0; square < 64; square++)
+                pieceKeys[piece][square] = random(seed);
+
+        // each combination of castle rights has its own key
+        for (int rights = 0; rights < 16; rights++)
+            castleKeys[rights] = random(seed);
+
+        for (int col = COL_A; col <= COL_H; col++)
+            enPassantKeys[col] = random(seed);
+
+        sideKey = random(seed);
+    }
+
+    // key of the piece in the square, piece should not be Empty
+    constexpr inline uint64_t getPieceKey(Piece piece, Square square) const { return pieceKeys[index(piece)][square]; }
+
+    // key of the 4 bits castle rights
+    constexpr inline uint64_t getCastleKey(uint8_t castleRights) const { return castleKeys[castleRights]; }
+
+    // key of the en passant square, square should be valid
+    constexpr inline uint64_t getEnPassantKey(Square square) const { return enPassantKeys[square.col()]; }
+
+    // key toggled when the side to move changes
+    constexpr inline uint64_t getSideKey() const { return sideKey; }
+
+private:
+    uint64_t pieceKeys[12][64];
+    uint64_t castleKeys[16];
+    uint64_t enPassantKeys[8];
+    uint64_t sideKey;
+
+    // xorshift64star pseudo random number generator
+    static constexpr uint64_t random(uint64_t &state)
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+};
+
+// keys generated at compile time
+inline constexpr Zobrist zobrist;
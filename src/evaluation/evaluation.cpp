@@ -0,0 +1,120 @@
+#include "evaluation.hpp"
+
+#include <bit>
+#include <iomanip>
+#include <sstream>
+
+/*
+ *   Middlegame and endgame value of a term
+ */
+struct TermScore
+{
+    int mg = 0;
+    int eg = 0;
+};
+
+static void printTerm(std::ostringstream &out, const char *name, const TermScore &white, const TermScore &black)
+{
+    out << std::setw(12) << name << " | "
+        << std::setw(6) << white.mg << " " << std::setw(6) << white.eg << " | "
+        << std::setw(6) << black.mg << " " << std::setw(6) << black.eg << " | "
+        << std::setw(6) << white.mg - black.mg << " " << std::setw(6) << white.eg - black.eg << "\n";
+}
+
+std::string traceEvaluation(const Board &board)
+{
+    static const char *pieceNames[6] = {"Pawns", "Knights", "Bishops", "Rooks", "Queens", "Kings"};
+    static const char *pawnTermNames[4] = {"Passed", "Isolated", "Doubled", "Backward"};
+
+    TermScore material[2][6], placement[2][6];
+    TermScore totalMaterial[2], totalPlacement[2];
+    int phase = 0;
+
+    for (int piece = 0; piece < 12; piece++)
+    {
+        const int type = piece % 6;
+        const int side = piece < 6 ? 0 : 1;
+        const Color pieceColor = side == 0 ? Color::WHITE : Color::BLACK;
+        uint64_t bitboard = board.bitBoards[piece];
+
+        while (bitboard)
+        {
+            const int square = std::countr_zero(bitboard);
+            bitboard &= bitboard - 1;
+
+            material[side][type].mg += materialMg[type];
+            material[side][type].eg += materialEg[type];
+            placement[side][type].mg += pstMg[type][pstIndex(pieceColor, square)];
+            placement[side][type].eg += pstEg[type][pstIndex(pieceColor, square)];
+            phase += gamePhaseValue[type];
+        }
+    }
+
+    std::ostringstream out;
+
+    out << "        Term |    White mg/eg |    Black mg/eg |    Total mg/eg\n"
+        << "-------------+----------------+----------------+---------------\n";
+
+    for (int type = 0; type < 6; type++)
+    {
+        for (int side = 0; side < 2; side++)
+        {
+            totalMaterial[side].mg += material[side][type].mg;
+            totalMaterial[side].eg += material[side][type].eg;
+            totalPlacement[side].mg += placement[side][type].mg;
+            totalPlacement[side].eg += placement[side][type].eg;
+        }
+
+        const TermScore white = {material[0][type].mg + placement[0][type].mg, material[0][type].eg + placement[0][type].eg};
+        const TermScore black = {material[1][type].mg + placement[1][type].mg, material[1][type].eg + placement[1][type].eg};
+
+        printTerm(out, pieceNames[type], white, black);
+    }
+
+    out << "-------------+----------------+----------------+---------------\n";
+
+    printTerm(out, "Material", totalMaterial[0], totalMaterial[1]);
+    printTerm(out, "Placement", totalPlacement[0], totalPlacement[1]);
+
+    const TermScore white = {totalMaterial[0].mg + totalPlacement[0].mg, totalMaterial[0].eg + totalPlacement[0].eg};
+    const TermScore black = {totalMaterial[1].mg + totalPlacement[1].mg, totalMaterial[1].eg + totalPlacement[1].eg};
+
+    // the pawn terms are not kept by the board
+    PawnEntry pawns;
+    PawnTrace pawnTrace;
+    TermScore pawnTotal[2];
+
+    evaluatePawns(board.bitBoards[index(Piece::WPawn)], board.bitBoards[index(Piece::BPawn)], pawns, &pawnTrace);
+
+    out << "-------------+----------------+----------------+---------------\n";
+
+    for (int term = 0; term < 4; term++)
+    {
+        const TermScore whiteTerm = {pawnTrace.mg[0][term], pawnTrace.eg[0][term]};
+        const TermScore blackTerm = {pawnTrace.mg[1][term], pawnTrace.eg[1][term]};
+
+        for (int side = 0; side < 2; side++)
+        {
+            pawnTotal[side].mg += pawnTrace.mg[side][term];
+            pawnTotal[side].eg += pawnTrace.eg[side][term];
+        }
+
+        printTerm(out, pawnTermNames[term], whiteTerm, blackTerm);
+    }
+
+    out << "-------------+----------------+----------------+---------------\n";
+
+    printTerm(out, "Pawn struct", pawnTotal[0], pawnTotal[1]);
+    printTerm(out, "Total", {white.mg + pawnTotal[0].mg, white.eg + pawnTotal[0].eg},
+              {black.mg + pawnTotal[1].mg, black.eg + pawnTotal[1].eg});
+
+    const int score = evaluate(board, pawns);
+
+    out << "\nGame phase: " << phase << " / " << MAX_GAME_PHASE << "\n"
+        << "Incremental mg/eg: " << board.mgScore << " / " << board.egScore
+        << (board.mgScore == white.mg - black.mg && board.egScore == white.eg - black.eg && board.gamePhase == phase ? "" : " (MISMATCH)") << "\n"
+        << "Pawn structure mg/eg: " << pawns.mg << " / " << pawns.eg << "\n"
+        << "Final evaluation: " << (board.sideToMove == Color::WHITE ? score : -score) << " cp (white side)\n";
+
+    return out.str();
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+/*
+    Static evaluation of the position
+    https://www.chessprogramming.org/Evaluation
+
+    Tapered material, piece-square and pawn structure evaluation, the middlegame
+    and endgame sums are kept by the board, see pieceSquareTable.hpp, the pawn
+    terms are cached in the pawn table of the thread, see pawnTable.hpp
+*/
+
+#include <string>
+
+#include "board.hpp"
+#include "pawnTable.hpp"
+
+/*
+ *   Value of each piece type in centipawns, used to order the captures
+ *   {PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING, EMPTY}
+ */
+constexpr int pieceValue[7] = {100, 320, 330, 500, 900, 0, 0};
+
+/*
+ *   Return the score of the position with the evaluation of its pawn structure
+ *   in centipawns from the side to move perspective, positive means the side to move is better
+ */
+inline int evaluate(const Board &board, const PawnEntry &pawns)
+{
+    // promotions can take the phase above the initial one
+    const int phase = board.gamePhase < MAX_GAME_PHASE ? board.gamePhase : MAX_GAME_PHASE;
+    const int mg = board.mgScore + pawns.mg;
+    const int eg = board.egScore + pawns.eg;
+    const int score = (mg * phase + eg * (MAX_GAME_PHASE - phase)) / MAX_GAME_PHASE;
+
+    return board.sideToMove == Color::WHITE ? score : -score;
+}
+
+/*
+ *   Return the score of the position in centipawns from the side to move perspective,
+ *   the pawn structure is taken from the table or evaluated and stored in it
+ */
+inline int evaluate(const Board &board, PawnTable &pawnTable)
+{
+    return evaluate(board, pawnTable.probe(board));
+}
+
+/*
+ *   Return a table with the material, piece-square and pawn structure terms of each side,
+ *   computed from scratch, and the final score. Used by the eval command.
+ */
+std::string traceEvaluation(const Board &board);
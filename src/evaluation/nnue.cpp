@@ -0,0 +1,247 @@
+#include "nnue.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "nnueKernels.hpp"
+
+Network network;
+
+bool Network::load(const std::string &path)
+{
+    unload();
+
+    if (!file.open(path))
+    {
+        return false;
+    }
+
+    const std::string_view data = file.view();
+
+    const std::size_t featureWeightsSize = sizeof(int16_t) * NNUE_INPUT_SIZE * NNUE_L1_SIZE;
+    const std::size_t featureBiasesSize = sizeof(int16_t) * NNUE_L1_SIZE;
+    const std::size_t hiddenWeightsSize = sizeof(int8_t) * NNUE_L2_SIZE * 2 * NNUE_L1_SIZE;
+    const std::size_t hiddenBiasesSize = sizeof(int32_t) * NNUE_L2_SIZE;
+    const std::size_t outputWeightsSize = sizeof(int8_t) * NNUE_L2_SIZE;
+    const std::size_t outputBiasSize = sizeof(int32_t);
+
+    const std::size_t expectedSize = sizeof(NnueHeader) + featureWeightsSize + featureBiasesSize + hiddenWeightsSize +
+                                     hiddenBiasesSize + outputWeightsSize + outputBiasSize;
+
+    NnueHeader header;
+
+    if (data.size() != expectedSize)
+    {
+        file.close();
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    if (std::memcmp(header.magic, NNUE_MAGIC, sizeof(header.magic)) != 0 || header.inputSize != NNUE_INPUT_SIZE ||
+        header.l1Size != NNUE_L1_SIZE || header.l2Size != NNUE_L2_SIZE)
+    {
+        file.close();
+        return false;
+    }
+
+    // the mapping is page aligned and all the sizes are multiples of 32 bytes, so every layer is aligned
+    const char *parameters = data.data() + sizeof(NnueHeader);
+
+    featureWeights = reinterpret_cast<const int16_t *>(parameters);
+    parameters += featureWeightsSize;
+    featureBiases = reinterpret_cast<const int16_t *>(parameters);
+    parameters += featureBiasesSize;
+    hiddenWeights = reinterpret_cast<const int8_t *>(parameters);
+    parameters += hiddenWeightsSize;
+    hiddenBiases = reinterpret_cast<const int32_t *>(parameters);
+    parameters += hiddenBiasesSize;
+    outputWeights = reinterpret_cast<const int8_t *>(parameters);
+    parameters += outputWeightsSize;
+    outputBias = reinterpret_cast<const int32_t *>(parameters);
+
+    // the weights are read in random order during the search, load all of them now
+    file.adviseWillNeed(data);
+
+    return true;
+}
+
+void Network::unload()
+{
+    file.close();
+
+    featureWeights = nullptr;
+    featureBiases = nullptr;
+    hiddenWeights = nullptr;
+    hiddenBiases = nullptr;
+    outputWeights = nullptr;
+    outputBias = nullptr;
+}
+
+/*
+ *   Bucket of the king square seen from the perspective, mirrored to the queen side
+ *   {a-b, c-d} x {rank 1, rank 2, ranks 3-4, ranks 5-8}
+ */
+static constexpr int kingBucketTable[8] = {0, 2, 4, 4, 6, 6, 6, 6};
+
+/*
+ *   The squares are flipped for black so each side sees itself at the bottom of the
+ *   board, and mirrored when the king is on the king side (files e-h)
+ */
+static inline int orientation(Color perspective, int kingSquare)
+{
+    return (perspective == Color::BLACK ? 56 : 0) ^ ((kingSquare & 7) >= 4 ? 7 : 0);
+}
+
+static inline int kingBucket(Color perspective, int kingSquare)
+{
+    const int oriented = kingSquare ^ orientation(perspective, kingSquare);
+
+    return kingBucketTable[oriented >> 3] + ((oriented & 7) >= 2 ? 1 : 0);
+}
+
+/*
+ *   The feature indexes only depend on the bucket and the orientation of the king,
+ *   a move of the king that keeps both does not need a refresh
+ */
+static inline int kingKey(Color perspective, int kingSquare)
+{
+    return kingBucket(perspective, kingSquare) * 2 + ((kingSquare & 7) >= 4 ? 1 : 0);
+}
+
+static inline int featureIndex(Color perspective, int kingSquare, Piece piece, int square)
+{
+    const int relativePiece = static_cast<int>(pieceToPieceType(piece)) + (color(piece) == perspective ? 0 : 6);
+
+    return kingBucket(perspective, kingSquare) * 768 + relativePiece * 64 + (square ^ orientation(perspective, kingSquare));
+}
+
+static inline const int16_t *featureRow(Color perspective, int kingSquare, Piece piece, int square)
+{
+    return network.featureWeights + featureIndex(perspective, kingSquare, piece, square) * NNUE_L1_SIZE;
+}
+
+static inline int kingSquareOf(const Board &board, Color perspective)
+{
+    return std::countr_zero(board.bitBoards[index(createPieceByTypeAndColor(PieceType::KING, perspective))]);
+}
+
+/*
+ *   Return true if the move changed the key of the king of the perspective
+ */
+static bool needsRefresh(const DirtyPieces &dirtyPieces, Color perspective)
+{
+    const Piece king = createPieceByTypeAndColor(PieceType::KING, perspective);
+    int from = -1, to = -1;
+
+    for (int i = 0; i < dirtyPieces.count; i++)
+    {
+        if (dirtyPieces.pieces[i].piece == king)
+        {
+            (dirtyPieces.pieces[i].added ? to : from) = dirtyPieces.pieces[i].square;
+        }
+    }
+
+    return from >= 0 && to >= 0 && kingKey(perspective, from) != kingKey(perspective, to);
+}
+
+void AccumulatorStack::refresh(const Board &board, Accumulator &accumulator, Color perspective)
+{
+    const int kingSquare = kingSquareOf(board, perspective);
+    const int16_t *rows[32];
+    int rowCount = 0;
+    uint64_t pieces = board.AllPiecesBB;
+
+    while (pieces && rowCount < 32)
+    {
+        const int square = std::countr_zero(pieces);
+        pieces &= pieces - 1;
+
+        rows[rowCount++] = featureRow(perspective, kingSquare, board.getPiece(square), square);
+    }
+
+    nnueKernels.updateAccumulator(network.featureBiases, accumulator.values[static_cast<int>(perspective)], NNUE_L1_SIZE,
+                                  rows, rowCount, nullptr, 0);
+
+    accumulator.computed[static_cast<int>(perspective)] = true;
+}
+
+void AccumulatorStack::update(const Board &board, Color perspective)
+{
+    const int side = static_cast<int>(perspective);
+
+    if (stack[top].computed[side])
+    {
+        return;
+    }
+
+    // find the closest computed entry, a king move on the way needs a refresh
+    int ply = top;
+
+    while (!stack[ply].computed[side])
+    {
+        if (ply == 0 || needsRefresh(stack[ply].dirtyPieces, perspective))
+        {
+            refresh(board, stack[top], perspective);
+            return;
+        }
+
+        ply--;
+    }
+
+    // the king key is the same in all the entries up to the current position
+    const int kingSquare = kingSquareOf(board, perspective);
+
+    for (ply++; ply <= top; ply++)
+    {
+        const DirtyPieces &dirtyPieces = stack[ply].dirtyPieces;
+        const int16_t *added[MAX_DIRTY_PIECES], *removed[MAX_DIRTY_PIECES];
+        int addedCount = 0, removedCount = 0;
+
+        for (int i = 0; i < dirtyPieces.count; i++)
+        {
+            const DirtyPiece &dirtyPiece = dirtyPieces.pieces[i];
+            const int16_t *row = featureRow(perspective, kingSquare, dirtyPiece.piece, dirtyPiece.square);
+
+            if (dirtyPiece.added)
+                added[addedCount++] = row;
+            else
+                removed[removedCount++] = row;
+        }
+
+        nnueKernels.updateAccumulator(stack[ply - 1].values[side], stack[ply].values[side], NNUE_L1_SIZE,
+                                      added, addedCount, removed, removedCount);
+
+        stack[ply].computed[side] = true;
+    }
+}
+
+int AccumulatorStack::evaluate(const Board &board)
+{
+    update(board, Color::WHITE);
+    update(board, Color::BLACK);
+
+    const Accumulator &accumulator = stack[top];
+    const int us = static_cast<int>(board.sideToMove);
+
+    alignas(64) uint8_t input[2 * NNUE_L1_SIZE];
+    alignas(64) int32_t hidden[NNUE_L2_SIZE];
+    alignas(64) uint8_t hiddenOutput[NNUE_L2_SIZE];
+    int32_t output;
+
+    // the side to move is always the first half of the input
+    nnueKernels.clippedRelu(accumulator.values[us], input, NNUE_L1_SIZE);
+    nnueKernels.clippedRelu(accumulator.values[us ^ 1], input + NNUE_L1_SIZE, NNUE_L1_SIZE);
+
+    nnueKernels.affine(input, 2 * NNUE_L1_SIZE, network.hiddenWeights, network.hiddenBiases, hidden, NNUE_L2_SIZE);
+
+    for (int i = 0; i < NNUE_L2_SIZE; i++)
+    {
+        hiddenOutput[i] = static_cast<uint8_t>(std::clamp(hidden[i] >> NNUE_WEIGHT_SHIFT, 0, 127));
+    }
+
+    nnueKernels.affine(hiddenOutput, NNUE_L2_SIZE, network.outputWeights, network.outputBias, &output, 1);
+
+    return output / NNUE_OUTPUT_SCALE;
+}
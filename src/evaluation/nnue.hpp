@@ -0,0 +1,141 @@
+#pragma once
+
+/*
+    Efficiently updatable neural network evaluation
+    https://www.chessprogramming.org/NNUE
+
+    (KING_BUCKETS x 768 -> 256) x 2 -> 32 -> 1
+
+    The inputs are the pieces of the board seen from each side (perspective),
+    relative to the bucket of the king of that side. The first layer (accumulator)
+    of each perspective is updated with the pieces changed by each move, it is
+    only computed from scratch when the king of the perspective changes of bucket.
+    The accumulators of the search path are kept in a stack, undoing a move pops
+    its entry. The output is the score from the side to move perspective.
+
+    The weights are read from a file mapped in memory, without copies.
+    Without a network the classical evaluation is used.
+*/
+
+#include <cstdint>
+#include <string>
+
+#include "board.hpp"
+#include "mappedFile.hpp"
+
+#define NNUE_KING_BUCKETS 8
+#define NNUE_INPUT_SIZE (NNUE_KING_BUCKETS * 12 * 64)
+#define NNUE_L1_SIZE 256
+#define NNUE_L2_SIZE 32
+
+// the hidden layer output is divided by 2^NNUE_WEIGHT_SHIFT before the activation
+#define NNUE_WEIGHT_SHIFT 6
+
+// the network output is the score in centipawns multiplied by NNUE_OUTPUT_SCALE
+#define NNUE_OUTPUT_SCALE 16
+
+// max plies of the accumulator stack, should be greater than the search MAX_PLY
+#define NNUE_STACK_SIZE 256
+
+#define NNUE_MAGIC "ADCNNUE1"
+
+/*
+ *   Header of the network file, followed by the little endian parameters:
+ *
+ *   int16 feature weights [NNUE_INPUT_SIZE][NNUE_L1_SIZE]
+ *   int16 feature biases  [NNUE_L1_SIZE]
+ *   int8  hidden weights  [NNUE_L2_SIZE][2 * NNUE_L1_SIZE]
+ *   int32 hidden biases   [NNUE_L2_SIZE]
+ *   int8  output weights  [NNUE_L2_SIZE]
+ *   int32 output bias
+ */
+struct NnueHeader
+{
+    char magic[8];
+    uint32_t inputSize;
+    uint32_t l1Size;
+    uint32_t l2Size;
+    uint32_t reserved[3];
+};
+
+static_assert(sizeof(NnueHeader) == 32, "the parameters after the header should be aligned");
+
+class Network
+{
+public:
+    Network() { unload(); }
+
+    ~Network() {}
+
+    // map the file and check the architecture, return false if it is not a valid network
+    bool load(const std::string &path);
+
+    // use the classical evaluation
+    void unload();
+
+    inline bool isLoaded() const { return featureWeights != nullptr; }
+
+    // parameters, they point to the mapping of the file
+    const int16_t *featureWeights;
+    const int16_t *featureBiases;
+    const int8_t *hiddenWeights;
+    const int32_t *hiddenBiases;
+    const int8_t *outputWeights;
+    const int32_t *outputBias;
+
+private:
+    MappedFile file;
+};
+
+// network used by all the search threads, should not be changed while searching
+extern Network network;
+
+/*
+ *   First layer of both perspectives after a move
+ */
+struct alignas(64) Accumulator
+{
+    int16_t values[2][NNUE_L1_SIZE];
+    bool computed[2];
+    DirtyPieces dirtyPieces; // pieces changed by the move that leads to this entry
+};
+
+/*
+ *   Accumulators of the positions of the search path, the entries are updated
+ *   lazily when a position is evaluated, from the closest computed entry
+ */
+class AccumulatorStack
+{
+public:
+    AccumulatorStack() : top(0) {}
+
+    ~AccumulatorStack() {}
+
+    // the position of the next evaluation is a new root, its accumulator will be computed from scratch
+    inline void reset()
+    {
+        top = 0;
+        stack[0].computed[0] = stack[0].computed[1] = false;
+    }
+
+    // call after Board::makeMove
+    inline void push(const Board &board)
+    {
+        Accumulator &entry = stack[++top];
+        entry.computed[0] = entry.computed[1] = false;
+        entry.dirtyPieces = board.dirtyPieces;
+    }
+
+    // call after Board::unmakeMove
+    inline void pop() { top--; }
+
+    // score of the position in centipawns from the side to move perspective, the network should be loaded
+    int evaluate(const Board &board);
+
+private:
+    Accumulator stack[NNUE_STACK_SIZE];
+    int top;
+
+    void update(const Board &board, Color perspective);
+    void refresh(const Board &board, Accumulator &accumulator, Color perspective);
+};
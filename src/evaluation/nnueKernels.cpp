@@ -0,0 +1,225 @@
+#include "nnueKernels.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define NNUE_X86
+#endif
+
+/*
+ *   Scalar
+ */
+
+static void updateAccumulatorScalar(const int16_t *input, int16_t *output, int size,
+                                    const int16_t *const *added, int addedCount,
+                                    const int16_t *const *removed, int removedCount)
+{
+    for (int i = 0; i < size; i++)
+    {
+        int16_t value = input[i];
+
+        for (int row = 0; row < addedCount; row++)
+            value += added[row][i];
+
+        for (int row = 0; row < removedCount; row++)
+            value -= removed[row][i];
+
+        output[i] = value;
+    }
+}
+
+static void clippedReluScalar(const int16_t *input, uint8_t *output, int size)
+{
+    for (int i = 0; i < size; i++)
+    {
+        output[i] = static_cast<uint8_t>(std::clamp<int16_t>(input[i], 0, 127));
+    }
+}
+
+static void affineScalar(const uint8_t *input, int inputSize, const int8_t *weights,
+                         const int32_t *bias, int32_t *output, int outputSize)
+{
+    for (int i = 0; i < outputSize; i++)
+    {
+        int32_t sum = bias[i];
+
+        for (int j = 0; j < inputSize; j++)
+            sum += input[j] * weights[i * inputSize + j];
+
+        output[i] = sum;
+    }
+}
+
+#ifdef NNUE_X86
+
+/*
+ *   The SIMD kernels are compiled with the target attribute instead of global
+ *   compiler flags, only the kernels chosen at runtime use the extended instructions
+ */
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+/*
+ *   SSE4.1, 8 int16 or 16 int8 values in each register
+ */
+
+TARGET_SSE41 static void updateAccumulatorSse41(const int16_t *input, int16_t *output, int size,
+                                                const int16_t *const *added, int addedCount,
+                                                const int16_t *const *removed, int removedCount)
+{
+    for (int i = 0; i < size; i += 8)
+    {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+
+        for (int row = 0; row < addedCount; row++)
+            value = _mm_add_epi16(value, _mm_loadu_si128(reinterpret_cast<const __m128i *>(added[row] + i)));
+
+        for (int row = 0; row < removedCount; row++)
+            value = _mm_sub_epi16(value, _mm_loadu_si128(reinterpret_cast<const __m128i *>(removed[row] + i)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), value);
+    }
+}
+
+TARGET_SSE41 static void clippedReluSse41(const int16_t *input, uint8_t *output, int size)
+{
+    const __m128i max = _mm_set1_epi16(127);
+
+    for (int i = 0; i < size; i += 16)
+    {
+        const __m128i low = _mm_min_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)), max);
+        const __m128i high = _mm_min_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i + 8)), max);
+
+        // packus saturates the negative values to 0
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packus_epi16(low, high));
+    }
+}
+
+TARGET_SSE41 static void affineSse41(const uint8_t *input, int inputSize, const int8_t *weights,
+                                     const int32_t *bias, int32_t *output, int outputSize)
+{
+    const __m128i ones = _mm_set1_epi16(1);
+
+    for (int i = 0; i < outputSize; i++)
+    {
+        const int8_t *row = weights + i * inputSize;
+        __m128i sum = _mm_setzero_si128();
+
+        for (int j = 0; j < inputSize; j += 16)
+        {
+            // u8 * i8 pairs added to i16 (127 * 127 * 2 does not saturate), then pairs added to i32
+            const __m128i products = _mm_maddubs_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + j)),
+                                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + j)));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(products, ones));
+        }
+
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        output[i] = bias[i] + _mm_cvtsi128_si32(sum);
+    }
+}
+
+/*
+ *   AVX2, 16 int16 or 32 int8 values in each register
+ */
+
+TARGET_AVX2 static void updateAccumulatorAvx2(const int16_t *input, int16_t *output, int size,
+                                              const int16_t *const *added, int addedCount,
+                                              const int16_t *const *removed, int removedCount)
+{
+    for (int i = 0; i < size; i += 16)
+    {
+        __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+
+        for (int row = 0; row < addedCount; row++)
+            value = _mm256_add_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(added[row] + i)));
+
+        for (int row = 0; row < removedCount; row++)
+            value = _mm256_sub_epi16(value, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(removed[row] + i)));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), value);
+    }
+}
+
+TARGET_AVX2 static void clippedReluAvx2(const int16_t *input, uint8_t *output, int size)
+{
+    const __m256i max = _mm256_set1_epi16(127);
+
+    for (int i = 0; i < size; i += 32)
+    {
+        const __m256i low = _mm256_min_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i)), max);
+        const __m256i high = _mm256_min_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i + 16)), max);
+
+        // packus works on each 128 bit lane, the permutation restores the order
+        const __m256i packed = _mm256_packus_epi16(low, high);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+    }
+}
+
+TARGET_AVX2 static void affineAvx2(const uint8_t *input, int inputSize, const int8_t *weights,
+                                   const int32_t *bias, int32_t *output, int outputSize)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+
+    for (int i = 0; i < outputSize; i++)
+    {
+        const int8_t *row = weights + i * inputSize;
+        __m256i sum = _mm256_setzero_si256();
+
+        for (int j = 0; j < inputSize; j += 32)
+        {
+            const __m256i products = _mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + j)),
+                                                          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(row + j)));
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(products, ones));
+        }
+
+        __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+        sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+
+        output[i] = bias[i] + _mm_cvtsi128_si32(sum128);
+    }
+}
+
+const NnueKernels sse41Kernels = {"sse4.1", updateAccumulatorSse41, clippedReluSse41, affineSse41};
+const NnueKernels avx2Kernels = {"avx2", updateAccumulatorAvx2, clippedReluAvx2, affineAvx2};
+
+#else
+
+// other architectures only have the scalar kernels
+const NnueKernels sse41Kernels = {"scalar", updateAccumulatorScalar, clippedReluScalar, affineScalar};
+const NnueKernels avx2Kernels = {"scalar", updateAccumulatorScalar, clippedReluScalar, affineScalar};
+
+#endif
+
+const NnueKernels scalarKernels = {"scalar", updateAccumulatorScalar, clippedReluScalar, affineScalar};
+
+bool kernelsSupported(const NnueKernels &kernels)
+{
+#ifdef NNUE_X86
+    __builtin_cpu_init();
+
+    if (&kernels == &avx2Kernels)
+        return __builtin_cpu_supports("avx2");
+
+    if (&kernels == &sse41Kernels)
+        return __builtin_cpu_supports("sse4.1");
+#endif
+
+    return true;
+}
+
+static NnueKernels selectKernels()
+{
+    if (kernelsSupported(avx2Kernels))
+        return avx2Kernels;
+
+    if (kernelsSupported(sse41Kernels))
+        return sse41Kernels;
+
+    return scalarKernels;
+}
+
+const NnueKernels nnueKernels = selectKernels();
@@ -0,0 +1,47 @@
+#pragma once
+
+/*
+    Integer kernels of the neural network evaluation.
+    There is an AVX2, an SSE4.1 and a scalar version of each kernel, the best one
+    supported by the cpu is chosen when the program starts, so the same binary
+    runs on any x86-64 cpu.
+*/
+
+#include <cstdint>
+
+/*
+ *   Kernels of one instruction set, sizes should be multiples of 32
+ */
+struct NnueKernels
+{
+    const char *name;
+
+    /*
+     *   output = input + sum(added rows) - sum(removed rows), int16 vectors of the given size.
+     *   Used to update the accumulator with the pieces of a move and to refresh it from the biases
+     */
+    void (*updateAccumulator)(const int16_t *input, int16_t *output, int size,
+                              const int16_t *const *added, int addedCount,
+                              const int16_t *const *removed, int removedCount);
+
+    // output = clamp(input, 0, 127)
+    void (*clippedRelu)(const int16_t *input, uint8_t *output, int size);
+
+    /*
+     *   Dense layer, output[i] = bias[i] + sum(input[j] * weights[i * inputSize + j])
+     *   with unsigned 8 bit inputs and signed 8 bit weights
+     */
+    void (*affine)(const uint8_t *input, int inputSize, const int8_t *weights,
+                   const int32_t *bias, int32_t *output, int outputSize);
+};
+
+// kernels of the best instruction set of the cpu
+extern const NnueKernels nnueKernels;
+
+// kernels of each instruction set, the cpu should support it
+extern const NnueKernels scalarKernels;
+extern const NnueKernels sse41Kernels;
+extern const NnueKernels avx2Kernels;
+
+// return true if the cpu supports the instruction set of the kernels
+bool kernelsSupported(const NnueKernels &kernels);
@@ -0,0 +1,142 @@
+#include "pawnTable.hpp"
+
+#include <bit>
+#include <cstring>
+
+constexpr uint64_t COL_A_BB = 0x0101010101010101ULL;
+constexpr uint64_t COL_H_BB = COL_A_BB << 7;
+
+enum PawnTerm
+{
+    PASSED,
+    ISOLATED,
+    DOUBLED,
+    BACKWARD
+};
+
+// fill the bitboard to the last row in front of the pawns of the color
+template <Color side>
+static inline uint64_t forwardFill(uint64_t bitboard)
+{
+    if constexpr (side == Color::WHITE)
+    {
+        bitboard |= bitboard << 8;
+        bitboard |= bitboard << 16;
+        bitboard |= bitboard << 32;
+    }
+    else
+    {
+        bitboard |= bitboard >> 8;
+        bitboard |= bitboard >> 16;
+        bitboard |= bitboard >> 32;
+    }
+
+    return bitboard;
+}
+
+template <Color side>
+static inline uint64_t forward(uint64_t bitboard)
+{
+    return side == Color::WHITE ? bitboard << 8 : bitboard >> 8;
+}
+
+template <Color side>
+static inline uint64_t pawnAttacks(uint64_t pawns)
+{
+    const uint64_t front = forward<side>(pawns);
+
+    return ((front & ~COL_A_BB) >> 1) | ((front & ~COL_H_BB) << 1);
+}
+
+static inline uint64_t fileFill(uint64_t bitboard)
+{
+    return forwardFill<Color::WHITE>(bitboard) | forwardFill<Color::BLACK>(bitboard);
+}
+
+/*
+ *   Evaluate the pawns of the side, the terms are positive for the side
+ */
+template <Color side>
+static void evaluatePawnsOf(uint64_t pawns, uint64_t enemyPawns, PawnEntry &entry, int mg[4], int eg[4])
+{
+    constexpr Color enemy = side == Color::WHITE ? Color::BLACK : Color::WHITE;
+    const int us = static_cast<int>(side);
+
+    const uint64_t attacks = pawnAttacks<side>(pawns);
+    const uint64_t enemyAttacks = pawnAttacks<enemy>(enemyPawns);
+
+    // the enemy pawns block the squares in front of them and the ones they can capture while advancing
+    const uint64_t enemyFrontSpan = forwardFill<enemy>(forward<enemy>(enemyPawns));
+    const uint64_t enemyAttackSpan = forwardFill<enemy>(enemyAttacks);
+
+    const uint64_t passed = pawns & ~(enemyFrontSpan | enemyAttackSpan);
+
+    const uint64_t files = fileFill(pawns);
+    const uint64_t isolated = pawns & ~(((files & ~COL_A_BB) >> 1) | ((files & ~COL_H_BB) << 1));
+
+    // pawns with a friendly pawn in front of them in the same column
+    const uint64_t doubled = pawns & forwardFill<enemy>(forward<enemy>(pawns));
+
+    // the stop square is attacked by an enemy pawn and no friendly pawn can defend it by advancing
+    const uint64_t attackSpan = forwardFill<side>(attacks);
+    const uint64_t backwardStops = forward<side>(pawns) & enemyAttacks & ~attackSpan;
+    const uint64_t backward = forward<enemy>(backwardStops) & ~isolated;
+
+    entry.passedPawns[us] = passed;
+    entry.pawnAttacks[us] = attacks;
+    entry.pawnAttackSpan[us] = attackSpan;
+
+    mg[PASSED] = eg[PASSED] = 0;
+
+    for (uint64_t bitboard = passed; bitboard; bitboard &= bitboard - 1)
+    {
+        const int row = std::countr_zero(bitboard) >> 3;
+        const int relativeRow = side == Color::WHITE ? row : 7 - row;
+
+        mg[PASSED] += passedPawnMg[relativeRow];
+        eg[PASSED] += passedPawnEg[relativeRow];
+    }
+
+    mg[ISOLATED] = ISOLATED_PAWN_MG * std::popcount(isolated);
+    eg[ISOLATED] = ISOLATED_PAWN_EG * std::popcount(isolated);
+    mg[DOUBLED] = DOUBLED_PAWN_MG * std::popcount(doubled);
+    eg[DOUBLED] = DOUBLED_PAWN_EG * std::popcount(doubled);
+    mg[BACKWARD] = BACKWARD_PAWN_MG * std::popcount(backward);
+    eg[BACKWARD] = BACKWARD_PAWN_EG * std::popcount(backward);
+}
+
+void evaluatePawns(uint64_t whitePawns, uint64_t blackPawns, PawnEntry &entry, PawnTrace *trace)
+{
+    int mg[2][4], eg[2][4];
+
+    evaluatePawnsOf<Color::WHITE>(whitePawns, blackPawns, entry, mg[0], eg[0]);
+    evaluatePawnsOf<Color::BLACK>(blackPawns, whitePawns, entry, mg[1], eg[1]);
+
+    int mgScore = 0, egScore = 0;
+
+    for (int term = PASSED; term <= BACKWARD; term++)
+    {
+        mgScore += mg[0][term] - mg[1][term];
+        egScore += eg[0][term] - eg[1][term];
+    }
+
+    entry.mg = static_cast<int16_t>(mgScore);
+    entry.eg = static_cast<int16_t>(egScore);
+
+    if (trace != nullptr)
+    {
+        std::memcpy(trace->mg, mg, sizeof(mg));
+        std::memcpy(trace->eg, eg, sizeof(eg));
+    }
+}
+
+/*
+ *   The empty entries have key 0 and all the terms 0, which is the evaluation
+ *   of the positions without pawns, whose pawn key is 0
+ */
+void PawnTable::clear()
+{
+    std::memset(static_cast<void *>(entries), 0, sizeof(entries));
+    probes = 0;
+    hits = 0;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+/*
+    Pawn structure evaluation and pawn hash table
+    https://www.chessprogramming.org/Pawn_Structure
+    https://www.chessprogramming.org/Pawn_Hash_Table
+
+    The pawn terms only depend on the pawns of both colors, which are the same
+    in most of the nodes of a search. Each search thread keeps a table indexed
+    by Board::pawnKey with the evaluation of each pawn structure and some masks
+    derived from it, so the pawns are evaluated once per structure.
+*/
+
+#include <cstdint>
+
+#include "board.hpp"
+
+// entries of the pawn table of each thread, should be a power of 2
+#define PAWN_TABLE_SIZE 16384
+
+/*
+ *   Middlegame and endgame bonus of a passed pawn by its relative row
+ */
+constexpr int passedPawnMg[8] = {0, 0, 5, 12, 25, 45, 75, 0};
+constexpr int passedPawnEg[8] = {0, 10, 15, 30, 50, 85, 130, 0};
+
+constexpr int ISOLATED_PAWN_MG = -10;
+constexpr int ISOLATED_PAWN_EG = -15;
+constexpr int DOUBLED_PAWN_MG = -10;
+constexpr int DOUBLED_PAWN_EG = -25;
+constexpr int BACKWARD_PAWN_MG = -8;
+constexpr int BACKWARD_PAWN_EG = -10;
+
+/*
+ *   Evaluation of a pawn structure, indexed by color in the masks
+ */
+struct alignas(64) PawnEntry
+{
+    uint64_t key;
+    uint64_t passedPawns[2];    // pawns without enemy pawns in front or able to capture them
+    uint64_t pawnAttacks[2];    // squares attacked by the pawns
+    uint64_t pawnAttackSpan[2]; // squares that the pawns attack or can attack when they advance
+    int16_t mg;                 // pawn terms from the white point of view
+    int16_t eg;
+};
+
+/*
+ *   Pawn terms of each color, in centipawns, filled by evaluatePawns for the eval command
+ *   {passed, isolated, doubled, backward}
+ */
+struct PawnTrace
+{
+    int mg[2][4];
+    int eg[2][4];
+};
+
+// evaluate the pawn structure from scratch, if trace is not null the terms are stored in it
+void evaluatePawns(uint64_t whitePawns, uint64_t blackPawns, PawnEntry &entry, PawnTrace *trace = nullptr);
+
+class PawnTable
+{
+public:
+    PawnTable() { clear(); }
+
+    ~PawnTable() {}
+
+    // the entry of the pawn structure of the board, it is evaluated if it is not in the table
+    inline const PawnEntry &probe(const Board &board)
+    {
+        PawnEntry &entry = entries[board.pawnKey & (PAWN_TABLE_SIZE - 1)];
+        probes++;
+
+        if (entry.key == board.pawnKey)
+        {
+            hits++;
+            return entry;
+        }
+
+        evaluatePawns(board.bitBoards[index(Piece::WPawn)], board.bitBoards[index(Piece::BPawn)], entry);
+        entry.key = board.pawnKey;
+
+        return entry;
+    }
+
+    // remove all the entries and reset the counters
+    void clear();
+
+    inline uint64_t getProbes() const { return probes; }
+    inline uint64_t getHits() const { return hits; }
+
+    // hits per thousand probes
+    inline uint64_t hitRate() const { return probes ? hits * 1000 / probes : 0; }
+
+private:
+    PawnEntry entries[PAWN_TABLE_SIZE];
+    uint64_t probes;
+    uint64_t hits;
+};
@@ -1,13 +1,29 @@
+#include <string>
+
 #include "uci.hpp"
+#include "analysis.hpp"
 
 
 int main(int argc, char* argv[])
 {
 
+    // batch mode: AlphaDeepChess analyse --input <file> --depth <N> [--threads <T>]
+    if (argc > 1 && std::string(argv[1]) == "analyse")
+    {
+        AnalysisOptions options;
+
+        if (!parseAnalysisOptions(argc - 2, argv + 2, options))
+        {
+            return 1;
+        }
+
+        return analyse(options);
+    }
+
     Uci uci;
 
 
     uci.loop();
 
    return 0; 
-}
\ No newline at end of file
+}
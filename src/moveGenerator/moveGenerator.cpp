@@ -1,156 +1,283 @@
 #include <bit>
+#include <cassert>
 
 #include "moveGenerator.hpp"
 #include "precomputedData.hpp"
 
-static PrecomputedData precomputedData;
-
-static Color sideToMove;
-static uint64_t pinMask;
-static uint64_t checkMask;
-static uint64_t enemyBB;
-static uint64_t friendlyBB;
-static Dir pawnMoveDir;
-static int pawnPrePromotionRow;
-static int pawnInitialRow;
+// bitboard masks used by the set-wise pawn generation
+constexpr uint64_t ROW_1_BB = 0xFFULL;
+constexpr uint64_t ROW_2_BB = ROW_1_BB << 8;
+constexpr uint64_t ROW_3_BB = ROW_1_BB << 16;
+constexpr uint64_t ROW_6_BB = ROW_1_BB << 40;
+constexpr uint64_t ROW_7_BB = ROW_1_BB << 48;
+constexpr uint64_t COL_A_BB = 0x0101010101010101ULL;
+constexpr uint64_t COL_H_BB = COL_A_BB << 7;
+
+// generation state, one copy for each search thread
+static thread_local Color sideToMove;
+static thread_local Color enemyColor;
+static thread_local Square kingSquare;
+static thread_local uint64_t checkers;  // enemy pieces giving check
+static thread_local uint64_t checkMask; // squares that capture the checker or block the check, all if not in check
+static thread_local uint64_t pinMask;   // friendly pieces pinned to the king
+static thread_local uint64_t pinRays[64]; // squares a pinned piece can move to, only valid for the pinned squares
+static thread_local uint64_t enemyBB;
+static thread_local uint64_t friendlyBB;
+static thread_local Dir pawnMoveDir;
+static thread_local Dir pawnCaptureLeftDir;  // capture towards the column A
+static thread_local Dir pawnCaptureRightDir; // capture towards the column H
+static thread_local uint64_t pawnPrePromotionRowBB;
+static thread_local uint64_t pawnDoublePushRowBB; // row reached by the first step of the double push
+static thread_local uint64_t targetMask; // squares the pieces can move to in this generation
 
 static void initializeVariables(MoveList &moves, const Board &board);
+static void calculateCheckMask(const Board &board);
 static void calculatePinMask(const Board &board);
-
-static void generatePawnMoves(MoveList &moves, Square square, const Board &board);
+static inline uint64_t legalMask(Square square);
+static bool isKingSafeAfterMove(const Board &board, Move move);
+static bool isPseudoLegal(const Board &board, Move move);
+static bool isSquareAttacked(const Board &board, Square square, Color attacker);
+static bool isSquareAttacked(const Board &board, Square square, Color attacker, uint64_t occupancy, uint64_t capturedMask);
+
+template <GenType genType>
+static void generatePawnMoves(MoveList &moves, const Board &board);
+template <GenType genType>
+static void generatePawnSetMoves(MoveList &moves, const Board &board, uint64_t pawns, uint64_t pawnsLegalMask);
+static void generateEnPassantMoves(MoveList &moves, const Board &board);
 static void generateRookMoves(MoveList &moves, Square square, const Board &board);
-static void generateKnightMoves(MoveList &moves, Square square, const Board &board);
+static void generateKnightMoves(MoveList &moves, uint64_t knights);
 static void generateBishopMoves(MoveList &moves, Square square, const Board &board);
 static void generateQueenMoves(MoveList &moves, Square square, const Board &board);
+template <GenType genType>
 static void generateKingMoves(MoveList &moves, Square square, const Board &board);
+static void generateCastleMoves(MoveList &moves, const Board &board);
+
+/*
+ *   Call the generator of the piece type for each piece in the bitboard,
+ *   the cost depends on the number of pieces and not on the size of the board
+ */
+template <void (*generator)(MoveList &, Square, const Board &)>
+static inline void generatePieceMoves(MoveList &moves, const Board &board, uint64_t pieces)
+{
+    while (pieces != 0)
+    {
+        // Find the index of the least significant set bit
+        const Square square = std::countr_zero(pieces);
+        // Clear the least significant set bit
+        pieces &= (pieces - 1);
 
-void generateLegalMoves(MoveList &moves, const Board &board)
+        generator(moves, square, board);
+    }
+}
+
+/*
+ *   The moves are generated legal: the pieces only move to the squares of the check mask
+ *   and the pinned pieces only along their pin ray, the king only to squares not attacked.
+ */
+template <GenType genType>
+void generate(MoveList &moves, const Board &board)
 {
     initializeVariables(moves, board);
 
-    for (Square square = SQ_A1; square <= SQ_H8; square++)
+    assert(genType != GenType::EVASIONS || checkers != 0);
+
+    if constexpr (genType == GenType::CAPTURES)
+    {
+        targetMask = enemyBB;
+    }
+    else if constexpr (genType == GenType::QUIETS)
+    {
+        targetMask = ~board.AllPiecesBB;
+    }
+    else
     {
-        if (board.empty(square) || board.getPieceColor(square) != sideToMove)
-            continue;
+        targetMask = ~friendlyBB;
+    }
 
-        switch (board.getPieceType(square))
-        {
-        case PieceType::PAWN:
-            // generatePawnMoves(moves, square, board);
-            break;
-        case PieceType::KNIGHT:
-            // generateKnightMoves(moves, square, board);
-            break;
-        case PieceType::BISHOP:
-            //generateBishopMoves(moves, square, board);
-            break;
-        case PieceType::ROOK:
-            // generateRookMoves(moves, square, board);
-            break;
-        case PieceType::QUEEN:
-            generateQueenMoves(moves, square, board);
-            break;
-        case PieceType::KING:
-            // generateKingMoves(moves, square, board);
-            break;
-        default:
-            break;
-        }
+    // in double check only the king can move
+    if (checkers & (checkers - 1))
+    {
+        generateKingMoves<genType>(moves, kingSquare, board);
+        return;
     }
+
+    const int offset = sideToMove == Color::WHITE ? 0 : 6;
+
+    generatePawnMoves<genType>(moves, board);
+    generateKnightMoves(moves, board.bitBoards[index(Piece::WKnight) + offset]);
+    generatePieceMoves<generateBishopMoves>(moves, board, board.bitBoards[index(Piece::WBishop) + offset]);
+    generatePieceMoves<generateRookMoves>(moves, board, board.bitBoards[index(Piece::WRook) + offset]);
+    generatePieceMoves<generateQueenMoves>(moves, board, board.bitBoards[index(Piece::WQueen) + offset]);
+    generateKingMoves<genType>(moves, kingSquare, board);
 }
 
+template void generate<GenType::CAPTURES>(MoveList &moves, const Board &board);
+template void generate<GenType::QUIETS>(MoveList &moves, const Board &board);
+template void generate<GenType::EVASIONS>(MoveList &moves, const Board &board);
+template void generate<GenType::ALL>(MoveList &moves, const Board &board);
+
 static void initializeVariables(MoveList &moves, const Board &board)
 {
     moves.clear();
     sideToMove = board.sideToMove;
+    enemyColor = sideToMove == Color::WHITE ? Color::BLACK : Color::WHITE;
     pawnMoveDir = sideToMove == Color::WHITE ? Dir::UP : Dir::DOWN;
-    pawnPrePromotionRow = sideToMove == Color::WHITE ? ROW_7 : ROW_2;
-    pawnInitialRow = sideToMove == Color::WHITE ? ROW_2 : ROW_7;
+    pawnCaptureLeftDir = sideToMove == Color::WHITE ? Dir::UPLEFT : Dir::DOWNLEFT;
+    pawnCaptureRightDir = sideToMove == Color::WHITE ? Dir::UPRIGHT : Dir::DOWNRIGHT;
+    pawnPrePromotionRowBB = sideToMove == Color::WHITE ? ROW_7_BB : ROW_2_BB;
+    pawnDoublePushRowBB = sideToMove == Color::WHITE ? ROW_3_BB : ROW_6_BB;
     enemyBB = board.enemyBB(sideToMove);
     friendlyBB = board.friendlyBB(sideToMove);
 
-    precomputedData.calculateMoves();
+    const Piece king = sideToMove == Color::WHITE ? Piece::WKing : Piece::BKing;
+    kingSquare = std::countr_zero(board.bitBoards[index(king)]);
 
+    calculateCheckMask(board);
     calculatePinMask(board);
 }
 
-static void generatePawnMoves(MoveList &moves, Square square, const Board &board)
+/*
+ *   Squares the piece in the square can move to without leaving the king in check
+ */
+static inline uint64_t legalMask(Square square)
 {
+    return (pinMask & square.mask()) ? pinRays[square] & checkMask : checkMask;
+}
 
-    const int row = square.row();
-    const int pushSquare = square + pawnMoveDir;
-
-    // get all the squares that the pawn attacks
-    uint64_t pawnAttacks =
-        sideToMove == Color::WHITE ? precomputedData.getPawnWhiteAttacks(square)
-                                   : precomputedData.getPawnBlackAttacks(square);
+// shift the whole bitboard one step in the direction
+static inline uint64_t shift(uint64_t bitboard, int dir)
+{
+    return dir > 0 ? bitboard << dir : bitboard >> -dir;
+}
 
-    // en passant
-    if (board.enPassantSquare.isValid() && pawnAttacks & (1UL << board.enPassantSquare))
+// add one move for each target square, the origin is the target minus the direction of the move
+static inline void addPawnMoves(MoveList &moves, uint64_t targets, int dir)
+{
+    while (targets != 0)
     {
-        moves.add(Move(square, board.enPassantSquare, MoveType::EN_PASSANT));
-    }
+        // Find the index of the least significant set bit
+        uint8_t squareTo = std::countr_zero(targets);
+        // Clear the least significant set bit
+        targets &= (targets - 1);
 
-    // only get the squares with enemy piece
-    pawnAttacks &= board.enemyBB(sideToMove);
+        moves.add(Move(squareTo - dir, squareTo));
+    }
+}
 
-    while (pawnAttacks != 0)
+static inline void addPawnPromotions(MoveList &moves, uint64_t targets, int dir)
+{
+    while (targets != 0)
     {
         // Find the index of the least significant set bit
-        uint8_t squareTo = std::countr_zero(pawnAttacks);
+        uint8_t squareTo = std::countr_zero(targets);
         // Clear the least significant set bit
-        pawnAttacks &= (pawnAttacks - 1);
+        targets &= (targets - 1);
 
-        if (row != pawnPrePromotionRow) // diagonal captures
-        {
-            moves.add(Move(square, squareTo));
-        }
-        else // diagonal captures and promotion
-        {
-            moves.add(Move(square, squareTo, MoveType::PROMOTION, PieceType::KNIGHT));
-            moves.add(Move(square, squareTo, MoveType::PROMOTION, PieceType::BISHOP));
-            moves.add(Move(square, squareTo, MoveType::PROMOTION, PieceType::ROOK));
-            moves.add(Move(square, squareTo, MoveType::PROMOTION, PieceType::QUEEN));
-        }
+        moves.add(Move(squareTo - dir, squareTo, MoveType::PROMOTION, PieceType::KNIGHT));
+        moves.add(Move(squareTo - dir, squareTo, MoveType::PROMOTION, PieceType::BISHOP));
+        moves.add(Move(squareTo - dir, squareTo, MoveType::PROMOTION, PieceType::ROOK));
+        moves.add(Move(squareTo - dir, squareTo, MoveType::PROMOTION, PieceType::QUEEN));
     }
+}
+
+/*
+ *   The pawns are generated set-wise, all the pawns that are not pinned move at once
+ *   with whole bitboard shifts. The pinned pawns are few, each one is generated with its pin ray.
+ */
+template <GenType genType>
+static void generatePawnMoves(MoveList &moves, const Board &board)
+{
+    const Piece pawn = sideToMove == Color::WHITE ? Piece::WPawn : Piece::BPawn;
+    const uint64_t pawns = board.bitBoards[index(pawn)];
 
-    // forward push and double push
+    generatePawnSetMoves<genType>(moves, board, pawns & ~pinMask, checkMask);
 
-    if (row == pawnInitialRow)
+    uint64_t pinnedPawns = pawns & pinMask;
+
+    while (pinnedPawns != 0)
     {
-        if (board.empty(pushSquare))
-        {
-            moves.add(Move(square, pushSquare)); // pawn push
+        const Square square = std::countr_zero(pinnedPawns);
+        pinnedPawns &= (pinnedPawns - 1);
 
-            const int doublePushSquare = pushSquare + pawnMoveDir;
-            if (board.empty(doublePushSquare))
-                moves.add(Move(square, doublePushSquare)); // initial double push
-        }
+        generatePawnSetMoves<genType>(moves, board, square.mask(), legalMask(square));
+    }
+
+    if constexpr (genType != GenType::QUIETS)
+    {
+        generateEnPassantMoves(moves, board);
+    }
+}
+
+/*
+ *   Generate the moves of the pawns in the bitboard, the target squares are limited by pawnsLegalMask
+ */
+template <GenType genType>
+static void generatePawnSetMoves(MoveList &moves, const Board &board, uint64_t pawns, uint64_t pawnsLegalMask)
+{
+    const uint64_t emptyBB = ~board.AllPiecesBB;
+    const uint64_t promotingPawns = pawns & pawnPrePromotionRowBB;
+    const uint64_t otherPawns = pawns & ~pawnPrePromotionRowBB;
+
+    if constexpr (genType != GenType::CAPTURES)
+    {
+        // the double push needs the first step empty, even if that square is not legal
+        const uint64_t pushes = shift(otherPawns, pawnMoveDir) & emptyBB;
+        const uint64_t doublePushes = shift(pushes & pawnDoublePushRowBB, pawnMoveDir) & emptyBB;
+
+        addPawnMoves(moves, pushes & pawnsLegalMask, pawnMoveDir);
+        addPawnMoves(moves, doublePushes & pawnsLegalMask, 2 * pawnMoveDir);
     }
-    else if (row == pawnPrePromotionRow)
+
+    if constexpr (genType != GenType::QUIETS)
     {
-        if (board.empty(pushSquare)) // push and promotion
+        const uint64_t captureTargets = enemyBB & pawnsLegalMask;
+
+        // the pawns on the edge column do not capture outside the board
+        addPawnMoves(moves, shift(otherPawns & ~COL_A_BB, pawnCaptureLeftDir) & captureTargets, pawnCaptureLeftDir);
+        addPawnMoves(moves, shift(otherPawns & ~COL_H_BB, pawnCaptureRightDir) & captureTargets, pawnCaptureRightDir);
+
+        if (promotingPawns != 0)
         {
-            moves.add(Move(square, pushSquare, MoveType::PROMOTION, PieceType::KNIGHT));
-            moves.add(Move(square, pushSquare, MoveType::PROMOTION, PieceType::BISHOP));
-            moves.add(Move(square, pushSquare, MoveType::PROMOTION, PieceType::ROOK));
-            moves.add(Move(square, pushSquare, MoveType::PROMOTION, PieceType::QUEEN));
+            addPawnPromotions(moves, shift(promotingPawns, pawnMoveDir) & emptyBB & pawnsLegalMask, pawnMoveDir);
+            addPawnPromotions(moves, shift(promotingPawns & ~COL_A_BB, pawnCaptureLeftDir) & captureTargets, pawnCaptureLeftDir);
+            addPawnPromotions(moves, shift(promotingPawns & ~COL_H_BB, pawnCaptureRightDir) & captureTargets, pawnCaptureRightDir);
         }
     }
-    else
+}
+
+/*
+ *   En passant removes two pieces from the row of the king, the discovered checks,
+ *   the pins and the check of the captured pawn are tested on the occupancy after the capture
+ */
+static void generateEnPassantMoves(MoveList &moves, const Board &board)
+{
+    if (!board.enPassantSquare.isValid())
+        return;
+
+    const Piece pawn = sideToMove == Color::WHITE ? Piece::WPawn : Piece::BPawn;
+
+    // the pawns that attack the square are the ones a pawn of the other color in the square would attack
+    uint64_t attackers = board.bitBoards[index(pawn)] &
+                         (sideToMove == Color::WHITE ? precomputedData.getPawnBlackAttacks(board.enPassantSquare)
+                                                     : precomputedData.getPawnWhiteAttacks(board.enPassantSquare));
+
+    while (attackers != 0)
     {
-        if (board.empty(pushSquare))
-            moves.add(Move(square, pushSquare)); // normal pawn push
+        const Square square = std::countr_zero(attackers);
+        attackers &= (attackers - 1);
+
+        const Move enPassant(square, board.enPassantSquare, MoveType::EN_PASSANT);
+
+        if (isKingSafeAfterMove(board, enPassant))
+            moves.add(enPassant);
     }
 }
 
 static void generateRookMoves(MoveList &moves, Square square, const Board &board)
 {
 
-    uint64_t blockers = board.AllPiecesBB & precomputedData.getRookAttacks(square);
-
     // filter the moves so we cant take a friendly piece
-    uint64_t rookMoves = precomputedData.getRookMoves(square, blockers) & ~friendlyBB;
+    uint64_t rookMoves = precomputedData.getRookMoves(square, board.AllPiecesBB) & targetMask & legalMask(square);
 
     while (rookMoves != 0)
     {
@@ -163,31 +290,39 @@ static void generateRookMoves(MoveList &moves, Square square, const Board &board
     }
 }
 
-static void generateKnightMoves(MoveList &moves, Square square, const Board &board)
+/*
+ *   The knight moves do not depend on the occupancy, only on the target and check masks,
+ *   so the knights of the bitboard are iterated here without the board
+ */
+static void generateKnightMoves(MoveList &moves, uint64_t knights)
 {
-    // get all the squares that the knight attacks
-    uint64_t knightAttacks = precomputedData.getKnightAttacks(square);
-
-    // only get the squares empty or with enemy piece
-    knightAttacks &= board.enemyOrEmptyBB(sideToMove);
+    // a pinned knight can not move, its moves never stay on the pin ray
+    knights &= ~pinMask;
 
-    while (knightAttacks != 0)
+    while (knights != 0)
     {
-        // Find the index of the least significant set bit
-        uint8_t squareTo = std::countr_zero(knightAttacks);
-        // Clear the least significant set bit
-        knightAttacks &= (knightAttacks - 1);
+        const Square square = std::countr_zero(knights);
+        knights &= (knights - 1);
 
-        moves.add(Move(square, squareTo));
+        // get all the squares that the knight attacks, only the squares empty or with enemy piece
+        uint64_t knightAttacks = precomputedData.getKnightAttacks(square) & targetMask & checkMask;
+
+        while (knightAttacks != 0)
+        {
+            // Find the index of the least significant set bit
+            uint8_t squareTo = std::countr_zero(knightAttacks);
+            // Clear the least significant set bit
+            knightAttacks &= (knightAttacks - 1);
+
+            moves.add(Move(square, squareTo));
+        }
     }
 }
 
 static void generateBishopMoves(MoveList &moves, Square square, const Board &board)
 {
-    uint64_t blockers = board.AllPiecesBB & precomputedData.getBishopAttacks(square);
-
     // filter the moves so we cant take a friendly piece
-    uint64_t bishopMoves = precomputedData.getBishopMoves(square, blockers) & ~friendlyBB;
+    uint64_t bishopMoves = precomputedData.getBishopMoves(square, board.AllPiecesBB) & targetMask & legalMask(square);
 
     while (bishopMoves != 0)
     {
@@ -202,11 +337,8 @@ static void generateBishopMoves(MoveList &moves, Square square, const Board &boa
 
 static void generateQueenMoves(MoveList &moves, Square square, const Board &board)
 {
-    uint64_t rookBlockers = board.AllPiecesBB & precomputedData.getRookAttacks(square);
-    uint64_t bishopBlockers = board.AllPiecesBB & precomputedData.getBishopAttacks(square);
-
-    // filter the moves so we cant take a friendly piece, we pass the orthogonal and diagonal blockers
-    uint64_t queenMoves = precomputedData.getQueenMoves(square, rookBlockers, bishopBlockers) & ~friendlyBB;
+    // filter the moves so we cant take a friendly piece
+    uint64_t queenMoves = precomputedData.getQueenMoves(square, board.AllPiecesBB) & targetMask & legalMask(square);
 
     while (queenMoves != 0)
     {
@@ -219,13 +351,22 @@ static void generateQueenMoves(MoveList &moves, Square square, const Board &boar
     }
 }
 
+template <GenType genType>
 static void generateKingMoves(MoveList &moves, Square square, const Board &board)
 {
     // get all the squares that the king attacks
     uint64_t kingAttacks = precomputedData.getKingAttacks(square);
 
-    // only get the squares empty or with enemy piece
-    kingAttacks &= board.enemyOrEmptyBB(sideToMove);
+    // the king does not block its own check, in evasions it can go to any square
+    if constexpr (genType == GenType::CAPTURES)
+        kingAttacks &= enemyBB;
+    else if constexpr (genType == GenType::QUIETS)
+        kingAttacks &= ~board.AllPiecesBB;
+    else
+        kingAttacks &= ~friendlyBB;
+
+    // the sliders attack through the king, a king moving away from a slider is still in check
+    const uint64_t occupancy = board.AllPiecesBB & ~square.mask();
 
     while (kingAttacks != 0)
     {
@@ -234,23 +375,39 @@ static void generateKingMoves(MoveList &moves, Square square, const Board &board
         // Clear the least significant set bit
         kingAttacks &= (kingAttacks - 1);
 
-        moves.add(Move(square, squareTo));
+        if (!isSquareAttacked(board, squareTo, enemyColor, occupancy, 0))
+            moves.add(Move(square, squareTo));
     }
 
-    // castling
+    // the king can not castle out of check
+    if constexpr (genType == GenType::QUIETS || genType == GenType::ALL)
+    {
+        if (checkers == 0)
+            generateCastleMoves(moves, board);
+    }
+}
 
-    if (sideToMove == Color::WHITE)
+static void generateCastleMoves(MoveList &moves, const Board &board)
+{
+    if (board.sideToMove == Color::WHITE)
     {
         if (board.getPiece(SQ_E1) == Piece::WKing)
         {
-            if (board.castleKWhite && board.empty(SQ_F1) && board.empty(SQ_G1) &&
-                board.getPiece(SQ_H1) == Piece::WRook)
+            // the king can not castle out of, through or into check
+            if ((board.castleRights & WHITE_KING_CASTLE) && board.empty(SQ_F1) && board.empty(SQ_G1) &&
+                board.getPiece(SQ_H1) == Piece::WRook &&
+                !isSquareAttacked(board, SQ_E1, Color::BLACK) &&
+                !isSquareAttacked(board, SQ_F1, Color::BLACK) &&
+                !isSquareAttacked(board, SQ_G1, Color::BLACK))
             {
                 moves.add(Move::castleWking());
             }
 
-            if (board.castleQWhite && board.empty(SQ_D1) && board.empty(SQ_C1) &&
-                board.empty(SQ_B1) && board.getPiece(SQ_H1) == Piece::WRook)
+            if ((board.castleRights & WHITE_QUEEN_CASTLE) && board.empty(SQ_D1) && board.empty(SQ_C1) &&
+                board.empty(SQ_B1) && board.getPiece(SQ_A1) == Piece::WRook &&
+                !isSquareAttacked(board, SQ_E1, Color::BLACK) &&
+                !isSquareAttacked(board, SQ_D1, Color::BLACK) &&
+                !isSquareAttacked(board, SQ_C1, Color::BLACK))
             {
                 moves.add(Move::castleWqueen());
             }
@@ -260,14 +417,21 @@ static void generateKingMoves(MoveList &moves, Square square, const Board &board
     {
         if (board.getPiece(SQ_E8) == Piece::BKing)
         {
-            if (board.castleKBlack && board.empty(SQ_F8) && board.empty(SQ_G8) &&
-                board.getPiece(SQ_H8) == Piece::BRook)
+            // the king can not castle out of, through or into check
+            if ((board.castleRights & BLACK_KING_CASTLE) && board.empty(SQ_F8) && board.empty(SQ_G8) &&
+                board.getPiece(SQ_H8) == Piece::BRook &&
+                !isSquareAttacked(board, SQ_E8, Color::WHITE) &&
+                !isSquareAttacked(board, SQ_F8, Color::WHITE) &&
+                !isSquareAttacked(board, SQ_G8, Color::WHITE))
             {
                 moves.add(Move::castleBking());
             }
 
-            if (board.castleQBlack && board.empty(SQ_D8) && board.empty(SQ_C8) &&
-                board.empty(SQ_B8) && board.getPiece(SQ_H8) == Piece::BRook)
+            if ((board.castleRights & BLACK_QUEEN_CASTLE) && board.empty(SQ_D8) && board.empty(SQ_C8) &&
+                board.empty(SQ_B8) && board.getPiece(SQ_A8) == Piece::BRook &&
+                !isSquareAttacked(board, SQ_E8, Color::WHITE) &&
+                !isSquareAttacked(board, SQ_D8, Color::WHITE) &&
+                !isSquareAttacked(board, SQ_C8, Color::WHITE))
             {
                 moves.add(Move::castleBqueen());
             }
@@ -275,6 +439,238 @@ static void generateKingMoves(MoveList &moves, Square square, const Board &board
     }
 }
 
+/*
+ *   The checkers are the enemy pieces attacking the king, with a single checker
+ *   the other pieces have to capture it or move between it and the king
+ */
+static void calculateCheckMask(const Board &board)
+{
+    checkers = board.attackersTo(kingSquare, board.AllPiecesBB) & board.friendlyBB(enemyColor);
+
+    if (checkers == 0)
+    {
+        checkMask = ~0ULL;
+    }
+    else if ((checkers & (checkers - 1)) == 0)
+    {
+        checkMask = checkers | precomputedData.getSquaresBetween(kingSquare, std::countr_zero(checkers));
+    }
+    else
+    {
+        checkMask = 0;
+    }
+}
+
+/*
+ *   X-ray from the king: the enemy sliders that would attack the king on an empty board
+ *   pin the friendly piece if it is the only piece between them and the king.
+ *   The pinned piece can only move between the king and the slider or capture it.
+ */
 static void calculatePinMask(const Board &board)
 {
+    const int offset = enemyColor == Color::WHITE ? 0 : 6;
+    const uint64_t queens = board.bitBoards[index(Piece::WQueen) + offset];
+    const uint64_t rooks = board.bitBoards[index(Piece::WRook) + offset] | queens;
+    const uint64_t bishops = board.bitBoards[index(Piece::WBishop) + offset] | queens;
+
+    uint64_t snipers = (precomputedData.getRookAttacks(kingSquare) & rooks) |
+                       (precomputedData.getBishopAttacks(kingSquare) & bishops);
+
+    pinMask = 0;
+
+    while (snipers != 0)
+    {
+        const Square sniper = std::countr_zero(snipers);
+        snipers &= (snipers - 1);
+
+        const uint64_t between = precomputedData.getSquaresBetween(kingSquare, sniper);
+        const uint64_t blockers = between & board.AllPiecesBB;
+
+        // exactly one blocker and it is friendly
+        if (blockers != 0 && (blockers & (blockers - 1)) == 0 && (blockers & friendlyBB))
+        {
+            pinMask |= blockers;
+            pinRays[std::countr_zero(blockers)] = between | sniper.mask();
+        }
+    }
+}
+
+bool isLegal(const Board &board, Move move)
+{
+    return isPseudoLegal(board, move) && isKingSafeAfterMove(board, move);
+}
+
+/*
+ *   Return true if the king of the side to move is not attacked after the pseudo legal move.
+ *   The attacks are calculated on the occupancy after the move, without making it.
+ */
+static bool isKingSafeAfterMove(const Board &board, Move move)
+{
+    const Color side = board.sideToMove;
+    const Color enemy = side == Color::WHITE ? Color::BLACK : Color::WHITE;
+    const Piece king = side == Color::WHITE ? Piece::WKing : Piece::BKing;
+    const Square from = move.squareFrom();
+    const Square to = move.squareTo();
+
+    // castle is generated only if the king does not pass through attacked squares
+    if (move.type() == MoveType::CASTLING)
+    {
+        return true;
+    }
+
+    Square kingSquare = board.getPiece(from) == king ? to : Square(std::countr_zero(board.bitBoards[index(king)]));
+    uint64_t capturedMask = to.mask();
+
+    if (move.type() == MoveType::EN_PASSANT)
+    {
+        capturedMask = Square(to + (side == Color::WHITE ? Dir::DOWN : Dir::UP)).mask();
+    }
+
+    const uint64_t occupancy = (board.AllPiecesBB & ~from.mask() & ~capturedMask) | to.mask();
+
+    return !isSquareAttacked(board, kingSquare, enemy, occupancy, capturedMask);
+}
+
+/*
+ *   Return true if the move can be played by the piece in the position,
+ *   without checking if the king is left in check
+ */
+static bool isPseudoLegal(const Board &board, Move move)
+{
+    // only promotions use the promotion piece bits
+    if (!move.isValid() || (move.type() != MoveType::PROMOTION && move.promotionPiece() != PieceType::KNIGHT))
+    {
+        return false;
+    }
+
+    const Color side = board.sideToMove;
+    const Square from = move.squareFrom();
+    const Square to = move.squareTo();
+
+    if (board.empty(from) || board.getPieceColor(from) != side ||
+        (!board.empty(to) && board.getPieceColor(to) == side))
+    {
+        return false;
+    }
+
+    const PieceType pieceType = board.getPieceType(from);
+    const uint64_t pawnAttacks = side == Color::WHITE ? precomputedData.getPawnWhiteAttacks(from)
+                                                      : precomputedData.getPawnBlackAttacks(from);
+
+    if (move.type() == MoveType::CASTLING)
+    {
+        MoveList castleMoves;
+        generateCastleMoves(castleMoves, board);
+
+        for (int i = 0; i < castleMoves.size(); i++)
+        {
+            if (castleMoves.get(i) == move)
+                return true;
+        }
+
+        return false;
+    }
+
+    if (move.type() == MoveType::EN_PASSANT)
+    {
+        return pieceType == PieceType::PAWN && board.enPassantSquare.isValid() &&
+               to == board.enPassantSquare && (pawnAttacks & to.mask());
+    }
+
+    if (pieceType == PieceType::PAWN)
+    {
+        const Dir pushDir = side == Color::WHITE ? Dir::UP : Dir::DOWN;
+        const int lastRow = side == Color::WHITE ? ROW_8 : ROW_1;
+        const int initialRow = side == Color::WHITE ? ROW_2 : ROW_7;
+
+        // the pawn promotes if and only if it reaches the last row
+        if ((to.row() == lastRow) != (move.type() == MoveType::PROMOTION))
+        {
+            return false;
+        }
+
+        if (pawnAttacks & to.mask())
+        {
+            return !board.empty(to);
+        }
+
+        if (to == from + pushDir)
+        {
+            return board.empty(to);
+        }
+
+        return from.row() == initialRow && to == from + 2 * pushDir &&
+               board.empty(from + pushDir) && board.empty(to);
+    }
+
+    if (move.type() == MoveType::PROMOTION)
+    {
+        return false;
+    }
+
+    uint64_t attacks = 0;
+
+    switch (pieceType)
+    {
+    case PieceType::KNIGHT:
+        attacks = precomputedData.getKnightAttacks(from);
+        break;
+    case PieceType::BISHOP:
+        attacks = precomputedData.getBishopMoves(from, board.AllPiecesBB);
+        break;
+    case PieceType::ROOK:
+        attacks = precomputedData.getRookMoves(from, board.AllPiecesBB);
+        break;
+    case PieceType::QUEEN:
+        attacks = precomputedData.getQueenMoves(from, board.AllPiecesBB);
+        break;
+    case PieceType::KING:
+        attacks = precomputedData.getKingAttacks(from);
+        break;
+    default:
+        break;
+    }
+
+    return attacks & to.mask();
+}
+
+bool inCheck(const Board &board)
+{
+    const Piece king = board.sideToMove == Color::WHITE ? Piece::WKing : Piece::BKing;
+    const Color enemy = board.sideToMove == Color::WHITE ? Color::BLACK : Color::WHITE;
+
+    return isSquareAttacked(board, std::countr_zero(board.bitBoards[index(king)]), enemy);
+}
+
+/*
+ *   Return true if any piece of the attacker color attacks the square
+ */
+static bool isSquareAttacked(const Board &board, Square square, Color attacker)
+{
+    return isSquareAttacked(board, square, attacker, board.AllPiecesBB, 0);
+}
+
+/*
+ *   Return true if any piece of the attacker color attacks the square,
+ *   the sliders are blocked by the given occupancy and the pieces in capturedMask do not attack
+ */
+static bool isSquareAttacked(const Board &board, Square square, Color attacker, uint64_t occupancy, uint64_t capturedMask)
+{
+    const int offset = attacker == Color::WHITE ? 0 : 6;
+    const uint64_t pawns = board.bitBoards[index(Piece::WPawn) + offset] & ~capturedMask;
+    const uint64_t knights = board.bitBoards[index(Piece::WKnight) + offset] & ~capturedMask;
+    const uint64_t bishops = board.bitBoards[index(Piece::WBishop) + offset] & ~capturedMask;
+    const uint64_t rooks = board.bitBoards[index(Piece::WRook) + offset] & ~capturedMask;
+    const uint64_t queens = board.bitBoards[index(Piece::WQueen) + offset] & ~capturedMask;
+    const uint64_t kings = board.bitBoards[index(Piece::WKing) + offset];
+
+    // a pawn of the attacker attacks the square if a pawn of the other color in the square would attack it
+    const uint64_t pawnAttacks = attacker == Color::WHITE ? precomputedData.getPawnBlackAttacks(square)
+                                                          : precomputedData.getPawnWhiteAttacks(square);
+
+    return (pawnAttacks & pawns) ||
+           (precomputedData.getKnightAttacks(square) & knights) ||
+           (precomputedData.getKingAttacks(square) & kings) ||
+           (precomputedData.getBishopMoves(square, occupancy) & (bishops | queens)) ||
+           (precomputedData.getRookMoves(square, occupancy) & (rooks | queens));
 }
\ No newline at end of file
@@ -2,4 +2,35 @@
 
 #include "board.hpp"
 
-void generateLegalMoves(MoveList &moves, const Board &board);
\ No newline at end of file
+/*
+ *   CAPTURES: captures, en passant captures and promotions
+ *   QUIETS: the moves that are not generated by CAPTURES
+ *   EVASIONS: the moves that can get out of check, the side to move should be in check
+ *   ALL: all the moves
+ */
+enum class GenType
+{
+    CAPTURES,
+    QUIETS,
+    EVASIONS,
+    ALL
+};
+
+/*
+ *   Generate the legal moves of the type, the target squares of the pieces are
+ *   selected at compile time so each entry point only pays for the moves it returns
+ */
+template <GenType genType>
+void generate(MoveList &moves, const Board &board);
+
+// all the legal moves
+inline void generateLegalMoves(MoveList &moves, const Board &board)
+{
+    generate<GenType::ALL>(moves, board);
+}
+
+// return true if the move is legal in the position, used to check moves stored in tables
+bool isLegal(const Board &board, Move move);
+
+// return true if the king of the side to move is attacked
+bool inCheck(const Board &board);
@@ -0,0 +1,392 @@
+#include "precomputedData.hpp"
+
+#include <bit>
+
+const PrecomputedData precomputedData;
+
+void PrecomputedData::initialize()
+{
+    initializeKingAttacks();
+    initializeKnightAttacks();
+    initializePawnAttacks();
+    initializeRookAttacks();
+    initializeBishopAttacks();
+    initializeQueenAttacks();
+
+    // the slider lookup tables depend on the rook and bishop attacks
+    initializeRookMoves();
+    initializeBishopMoves();
+    initializeSquaresBetween();
+}
+
+void PrecomputedData::initializeKingAttacks()
+{
+    for (int row = ROW_1; row <= ROW_8; row++)
+    {
+        for (int col = COL_A; col <= COL_H; col++)
+        {
+            if (validCoord(row + 1, col))
+                kingAttacks[Square(row, col)] |= 1UL << Square(row + 1, col);
+
+            if (validCoord(row - 1, col))
+                kingAttacks[Square(row, col)] |= 1UL << Square(row - 1, col);
+
+            if (validCoord(row, col + 1))
+                kingAttacks[Square(row, col)] |= 1UL << Square(row, col + 1);
+
+            if (validCoord(row, col - 1))
+                kingAttacks[Square(row, col)] |= 1UL << Square(row, col - 1);
+
+            if (validCoord(row + 1, col + 1))
+                kingAttacks[Square(row, col)] |= 1UL << Square(row + 1, col + 1);
+
+            if (validCoord(row + 1, col - 1))
+                kingAttacks[Square(row, col)] |= 1UL << Square(row + 1, col - 1);
+
+            if (validCoord(row - 1, col + 1))
+                kingAttacks[Square(row, col)] |= 1UL << Square(row - 1, col + 1);
+
+            if (validCoord(row - 1, col - 1))
+                kingAttacks[Square(row, col)] |= 1UL << Square(row - 1, col - 1);
+        }
+    }
+}
+
+void PrecomputedData::initializeKnightAttacks()
+{
+    for (int row = ROW_1; row <= ROW_8; row++)
+    {
+        for (int col = COL_A; col <= COL_H; col++)
+        {
+            if (validCoord(row + 2, col + 1))
+                knightAttacks[Square(row, col)] |= 1UL << Square(row + 2, col + 1);
+
+            if (validCoord(row + 2, col - 1))
+                knightAttacks[Square(row, col)] |= 1UL << Square(row + 2, col - 1);
+
+            if (validCoord(row - 2, col + 1))
+                knightAttacks[Square(row, col)] |= 1UL << Square(row - 2, col + 1);
+
+            if (validCoord(row - 2, col - 1))
+                knightAttacks[Square(row, col)] |= 1UL << Square(row - 2, col - 1);
+
+            if (validCoord(row + 1, col + 2))
+                knightAttacks[Square(row, col)] |= 1UL << Square(row + 1, col + 2);
+
+            if (validCoord(row + 1, col - 2))
+                knightAttacks[Square(row, col)] |= 1UL << Square(row + 1, col - 2);
+
+            if (validCoord(row - 1, col + 2))
+                knightAttacks[Square(row, col)] |= 1UL << Square(row - 1, col + 2);
+
+            if (validCoord(row - 1, col - 2))
+                knightAttacks[Square(row, col)] |= 1UL << Square(row - 1, col - 2);
+        }
+    }
+}
+
+void PrecomputedData::initializePawnAttacks()
+{
+    for (int row = ROW_1; row <= ROW_8; row++)
+    {
+        for (int col = COL_A; col <= COL_H; col++)
+        {
+            if (validCoord(row + 1, col + 1))
+                pawnWhiteAttacks[Square(row, col)] |= 1UL << Square(row + 1, col + 1);
+
+            if (validCoord(row + 1, col - 1))
+                pawnWhiteAttacks[Square(row, col)] |= 1UL << Square(row + 1, col - 1);
+
+            if (validCoord(row - 1, col + 1))
+                pawnBlackAttacks[Square(row, col)] |= 1UL << Square(row - 1, col + 1);
+
+            if (validCoord(row - 1, col - 1))
+                pawnBlackAttacks[Square(row, col)] |= 1UL << Square(row - 1, col - 1);
+        }
+    }
+}
+
+void PrecomputedData::initializeRookAttacks()
+{
+    for (int row = ROW_1; row <= ROW_8; row++)
+    {
+        for (int col = COL_A; col <= COL_H; col++)
+        {
+            int auxRow = ROW_1;
+            while (auxRow <= ROW_8)
+            {
+                if (validCoord(auxRow, col) && auxRow != row)
+                    rookAttacks[Square(row, col)] |= 1UL << Square(auxRow, col);
+
+                auxRow++;
+            }
+
+            int auxCol = COL_A;
+
+            while (auxCol <= COL_H)
+            {
+                if (validCoord(row, auxCol) && auxCol != col)
+                    rookAttacks[Square(row, col)] |= 1UL << Square(row, auxCol);
+
+                auxCol++;
+            }
+        }
+    }
+}
+void PrecomputedData::initializeBishopAttacks()
+{
+    for (int row = ROW_1; row <= ROW_8; row++)
+    {
+        for (int col = COL_A; col <= COL_H; col++)
+        {
+            int auxRow = row > col ? row - col : ROW_1;
+            int auxCol = row > col ? COL_A : col - row;
+
+            while (auxRow <= ROW_8 && auxCol <= COL_H)
+            {
+                if (row != auxRow && col != auxCol)
+                    bishopAttacks[Square(row, col)] |= 1UL << Square(auxRow, auxCol);
+
+                auxRow++;
+                auxCol++;
+            }
+
+            auxRow = (7 - row) > col ? row + col : ROW_8;
+            auxCol = (7 - row) > col ? COL_A : col - (7 - row);
+
+            while (auxRow >= ROW_1 && auxCol <= COL_H)
+            {
+                if (row != auxRow && col != auxCol)
+                    bishopAttacks[Square(row, col)] |= 1UL << Square(auxRow, auxCol);
+
+                auxRow--;
+                auxCol++;
+            }
+        }
+    }
+}
+
+void PrecomputedData::initializeQueenAttacks()
+{
+    for (Square square = SQ_A1; square <= SQ_H8; square++)
+    {
+        queenAttacks[square] = rookAttacks[square] | bishopAttacks[square];
+    }
+}
+
+void PrecomputedData::initializeRookMoves()
+{
+    initializeMagics(rookMagics, rookTable, true);
+}
+
+void PrecomputedData::initializeBishopMoves()
+{
+    initializeMagics(bishopMagics, bishopTable, false);
+}
+
+void PrecomputedData::initializeSquaresBetween()
+{
+    for (Square squareA = SQ_A1; squareA <= SQ_H8; squareA++)
+    {
+        for (Square squareB = SQ_A1; squareB <= SQ_H8; squareB++)
+        {
+            // the rays of each square blocked by the other square overlap between them
+            if (getRookAttacks(squareA) & squareB.mask())
+            {
+                squaresBetween[squareA][squareB] = getRookMoves(squareA, squareB.mask()) & getRookMoves(squareB, squareA.mask());
+            }
+            else if (getBishopAttacks(squareA) & squareB.mask())
+            {
+                squaresBetween[squareA][squareB] = getBishopMoves(squareA, squareB.mask()) & getBishopMoves(squareB, squareA.mask());
+            }
+        }
+    }
+}
+
+#ifndef USE_PEXT
+/*
+ *   xorshift64star pseudo random number generator, fixed seed so the magics
+ *   found are the same on every run.
+ */
+static uint64_t randomU64()
+{
+    static uint64_t state = 1070372ULL;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+// random number with few bits set, good magic candidates
+static uint64_t sparseRandomU64()
+{
+    return randomU64() & randomU64() & randomU64();
+}
+#endif
+
+/*
+ *   Fill the magic entries and the flat table of the slider.
+ *   For every square we enumerate all the subsets of the relevant blockers mask,
+ *   calculate the moves for each subset and search a magic number that maps
+ *   every subset to an index without destructive collisions.
+ */
+void PrecomputedData::initializeMagics(Magic magics[64], uint64_t table[], bool rook)
+{
+    // the first and last row/col do not block the rays, unless the piece is on them
+    constexpr uint64_t ROW_1_BB = 0xFFULL;
+    constexpr uint64_t ROW_8_BB = ROW_1_BB << 56;
+    constexpr uint64_t COL_A_BB = 0x0101010101010101ULL;
+    constexpr uint64_t COL_H_BB = COL_A_BB << 7;
+
+#ifndef USE_PEXT
+    uint64_t occupancy[4096], reference[4096];
+    int epoch[4096] = {0};
+    int attempt = 0;
+#endif
+    std::size_t offset = 0;
+
+    for (Square square = SQ_A1; square <= SQ_H8; square++)
+    {
+        const uint64_t squareRow = ROW_1_BB << (8 * square.row());
+        const uint64_t squareCol = COL_A_BB << square.col();
+        const uint64_t edges = ((ROW_1_BB | ROW_8_BB) & ~squareRow) | ((COL_A_BB | COL_H_BB) & ~squareCol);
+
+        Magic &m = magics[square];
+        m.mask = (rook ? getRookAttacks(square) : getBishopAttacks(square)) & ~edges;
+        m.shift = 64 - std::popcount(m.mask);
+        m.attacks = table + offset;
+
+        // Carry-Rippler trick to enumerate all subsets of the mask
+        int size = 0;
+        uint64_t blockers = 0;
+        do
+        {
+            const uint64_t moves = rook ? calculateLegalRookMoves(square, blockers)
+                                        : calculateLegalBishopMoves(square, blockers);
+#ifdef USE_PEXT
+            m.attacks[_pext_u64(blockers, m.mask)] = moves;
+#else
+            occupancy[size] = blockers;
+            reference[size] = moves;
+#endif
+            size++;
+            blockers = (blockers - m.mask) & m.mask;
+        } while (blockers);
+
+        offset += size;
+
+#ifndef USE_PEXT
+        // try random magics until one of them maps all the subsets correctly
+        for (int i = 0; i < size;)
+        {
+            do
+            {
+                m.magic = sparseRandomU64();
+            } while (std::popcount((m.magic * m.mask) >> 56) < 6);
+
+            // epoch avoids clearing the slice on every attempt
+            attempt++;
+            for (i = 0; i < size; i++)
+            {
+                unsigned idx = m.index(occupancy[i]);
+
+                if (epoch[idx] < attempt)
+                {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                }
+                else if (m.attacks[idx] != reference[i])
+                {
+                    break;
+                }
+            }
+        }
+#endif
+    }
+}
+
+uint64_t PrecomputedData::calculateLegalRookMoves(Square square, uint64_t blockerBB)
+{
+    uint64_t movesBitboard = 0;
+
+    int row = square.row();
+    int col = square.col();
+
+    int rookDirections[4][2] = {
+        {1, 0},  // Up
+        {-1, 0}, // Down
+        {0, 1},  // Right
+        {0, -1}  // Left
+    };
+
+    for (int i = 0; i < 4; ++i)
+    {
+        int dirRow = rookDirections[i][0];
+        int dirCol = rookDirections[i][1];
+
+        int auxRow = row + dirRow;
+        int auxCol = col + dirCol;
+
+        while (validCoord(auxRow, auxCol))
+        {
+            Square auxSquare = Square(auxRow, auxCol);
+
+            // set the square to 1 in the bitboard
+            movesBitboard |= auxSquare.mask();
+
+            // if there is a blocker in the square we stop in this direction
+            if (blockerBB & auxSquare.mask())
+            {
+                break;
+            }
+
+            auxRow += dirRow;
+            auxCol += dirCol;
+        }
+    }
+
+    return movesBitboard;
+}
+
+uint64_t PrecomputedData::calculateLegalBishopMoves(Square square, uint64_t blockerBB)
+{
+    uint64_t movesBitboard = 0;
+
+    int row = square.row();
+    int col = square.col();
+
+    int bishopDirections[4][2] = {
+        {1, 1},  // Up-right
+        {1, -1}, // Up-left
+        {-1, 1}, // Down-right
+        {-1, -1} // Down-left
+    };
+
+    for (int i = 0; i < 4; ++i)
+    {
+        int dirRow = bishopDirections[i][0];
+        int dirCol = bishopDirections[i][1];
+
+        int auxRow = row + dirRow;
+        int auxCol = col + dirCol;
+
+        while (validCoord(auxRow, auxCol))
+        {
+            Square auxSquare = Square(auxRow, auxCol);
+
+            // set the square to 1 in the bitboard
+            movesBitboard |= auxSquare.mask();
+
+            // if there is a blocker in the square we stop in this direction
+            if (blockerBB & auxSquare.mask())
+            {
+                break;
+            }
+
+            auxRow += dirRow;
+            auxCol += dirCol;
+        }
+    }
+
+    return movesBitboard;
+}
\ No newline at end of file
@@ -1,29 +1,65 @@
 #pragma once
 
-#include <unordered_map>
+#include <cstddef>
+
+#ifdef USE_PEXT
+#include <immintrin.h>
+#endif
 
 #include "types.hpp"
 #include "square.hpp"
 
-class PrecomputedData
+/*
+ *   Number of entries of the flat slider tables, one entry for each
+ *   relevant blocker configuration of each square.
+ *   Rook: 102400 entries, Bishop: 5248 entries, 841 KB in total.
+ */
+constexpr std::size_t ROOK_TABLE_SIZE = 0x19000;
+constexpr std::size_t BISHOP_TABLE_SIZE = 0x1480;
+
+/*
+ *   Fancy magic bitboard entry of one square.
+ *
+ *   The relevant blockers (occupancy & mask) are mapped to a unique index
+ *   of the square slice of the flat table, with a magic multiplication or,
+ *   if the build has BMI2 enabled (USE_PEXT), with the pext instruction.
+ *
+ *   https://www.chessprogramming.org/Magic_Bitboards
+ */
+struct Magic
 {
-public:
-    constexpr PrecomputedData() { initialize(); }
+    uint64_t *attacks; // slice of the flat table of this square
+    uint64_t mask;     // relevant blockers, the edges of the rays are excluded
+    uint64_t magic;
+    unsigned shift;
 
-    ~PrecomputedData()
+    inline unsigned index(uint64_t occupancy) const
     {
-        for (int i = 0; i < 64; i++)
-        {
-            delete rookMoves[i];
-            delete bishopMoves[i];
-        }
+#ifdef USE_PEXT
+        return static_cast<unsigned>(_pext_u64(occupancy, mask));
+#else
+        return static_cast<unsigned>(((occupancy & mask) * magic) >> shift);
+#endif
     }
+};
+
+/*
+ *   Attack and move lookup tables.
+ *
+ *   The tables are built once by the constructor of the global instance
+ *   (precomputedData), during static initialization at process start,
+ *   and are read only for the rest of the program.
+ */
+class PrecomputedData
+{
+public:
+    PrecomputedData() { initialize(); }
+
+    ~PrecomputedData() {}
+
+    PrecomputedData(const PrecomputedData &) = delete;
+    PrecomputedData &operator=(const PrecomputedData &) = delete;
 
-    void calculateMoves()
-    {
-        initializeRookMoves();
-        initializeBishopMoves();
-    };
     /*
      *   Return the 64 bit mask with 1 on the squares that the piece in the provided square is attacking on an empty board
      *   square should be valid
@@ -66,41 +102,50 @@ public:
      */
     inline uint64_t getQueenAttacks(Square square) const { return queenAttacks[square]; }
 
+    /*
+     *   Return the 64 bit mask with 1 on the squares between the two squares (both excluded)
+     *   if they are on the same row, column or diagonal, 0 otherwise
+     */
+    inline uint64_t getSquaresBetween(Square squareA, Square squareB) const { return squaresBetween[squareA][squareB]; }
+
     /*
      *   Lookup table for rook moves gives the rook square and the bitboard of blockers.
+     *   The blockers can be the whole occupancy, the irrelevant squares are masked out.
      */
-    inline uint64_t getRookMoves(Square rookSquare, uint64_t blockers) const { return (*rookMoves[rookSquare])[blockers]; }
+    inline uint64_t getRookMoves(Square rookSquare, uint64_t blockers) const
+    {
+        const Magic &m = rookMagics[rookSquare];
+        return m.attacks[m.index(blockers)];
+    }
 
     /*
      *   Lookup table for bishop moves gives the bishop square and the bitboard of blockers.
+     *   The blockers can be the whole occupancy, the irrelevant squares are masked out.
      */
-    inline uint64_t getBishopMoves(Square bishopSquare, uint64_t blockers) const { return (*bishopMoves[bishopSquare])[blockers]; }
+    inline uint64_t getBishopMoves(Square bishopSquare, uint64_t blockers) const
+    {
+        const Magic &m = bishopMagics[bishopSquare];
+        return m.attacks[m.index(blockers)];
+    }
 
     /*
      *   Lookup table for queen moves gives the queen square and the bitboard of blockers.
-     *   Input should be the horizontal and vertical blockers(rook), and the diagonal blockers(bishop)
      */
-    inline uint64_t getQueenMoves(Square queenSquare, uint64_t blockersRook, uint64_t blockersBishop) const
+    inline uint64_t getQueenMoves(Square queenSquare, uint64_t blockers) const
     {
-        return getRookMoves(queenSquare, blockersRook) | getBishopMoves(queenSquare, blockersBishop);
+        return getRookMoves(queenSquare, blockers) | getBishopMoves(queenSquare, blockers);
     }
 
 private:
     /*
-     *   Array of Lookup tables for each square.
-     *
-     *   Basically this is a dictionary for the rook moves given
-     *   the square of the rook and the bitboard of blocker pieces.
+     *   Flat lookup tables of slider moves, each square owns a contiguous slice
+     *   that is indexed by its magic entry.
      */
-    std::unordered_map<uint64_t, uint64_t> *rookMoves[64] = {nullptr};
+    alignas(64) uint64_t rookTable[ROOK_TABLE_SIZE];
+    alignas(64) uint64_t bishopTable[BISHOP_TABLE_SIZE];
 
-    /*
-     *   Array of Lookup tables for each square.
-     *
-     *   Basically this is a dictionary for the bishop moves given
-     *   the square of the bishop and the bitboard of blocker pieces.
-     */
-    std::unordered_map<uint64_t, uint64_t> *bishopMoves[64] = {nullptr};
+    Magic rookMagics[64];
+    Magic bishopMagics[64];
 
     uint64_t kingAttacks[64] = {0};
     uint64_t knightAttacks[64] = {0};
@@ -109,360 +154,25 @@ private:
     uint64_t queenAttacks[64] = {0};
     uint64_t pawnWhiteAttacks[64] = {0};
     uint64_t pawnBlackAttacks[64] = {0};
+    uint64_t squaresBetween[64][64] = {{0}};
 
-    constexpr void initialize();
-    constexpr void initializeKingAttacks();
-    constexpr void initializeKnightAttacks();
-    constexpr void initializePawnAttacks();
-    constexpr void initializeRookAttacks();
-    constexpr void initializeBishopAttacks();
-    constexpr void initializeQueenAttacks();
+    void initialize();
+    void initializeKingAttacks();
+    void initializeKnightAttacks();
+    void initializePawnAttacks();
+    void initializeRookAttacks();
+    void initializeBishopAttacks();
+    void initializeQueenAttacks();
 
     void initializeRookMoves();
     void initializeBishopMoves();
+    void initializeSquaresBetween();
 
-    void calculateRookMoves(Square square);
-    void calculateBishopMoves(Square square);
+    void initializeMagics(Magic magics[64], uint64_t table[], bool rook);
 
-    uint64_t calculateLegalRookMoves(Square square, uint64_t blockerBB);
-    uint64_t calculateLegalBishopMoves(Square square, uint64_t blockerBB);
+    static uint64_t calculateLegalRookMoves(Square square, uint64_t blockerBB);
+    static uint64_t calculateLegalBishopMoves(Square square, uint64_t blockerBB);
 };
 
-constexpr void PrecomputedData::initialize()
-{
-    initializeKingAttacks();
-    initializeKnightAttacks();
-    initializePawnAttacks();
-    initializeRookAttacks();
-    initializeBishopAttacks();
-    initializeQueenAttacks();
-}
-
-constexpr void PrecomputedData::initializeKingAttacks()
-{
-    for (int row = ROW_1; row <= ROW_8; row++)
-    {
-        for (int col = COL_A; col <= COL_H; col++)
-        {
-            if (validCoord(row + 1, col))
-                kingAttacks[Square(row, col)] |= 1UL << Square(row + 1, col);
-
-            if (validCoord(row - 1, col))
-                kingAttacks[Square(row, col)] |= 1UL << Square(row - 1, col);
-
-            if (validCoord(row, col + 1))
-                kingAttacks[Square(row, col)] |= 1UL << Square(row, col + 1);
-
-            if (validCoord(row, col - 1))
-                kingAttacks[Square(row, col)] |= 1UL << Square(row, col - 1);
-
-            if (validCoord(row + 1, col + 1))
-                kingAttacks[Square(row, col)] |= 1UL << Square(row + 1, col + 1);
-
-            if (validCoord(row + 1, col - 1))
-                kingAttacks[Square(row, col)] |= 1UL << Square(row + 1, col - 1);
-
-            if (validCoord(row - 1, col + 1))
-                kingAttacks[Square(row, col)] |= 1UL << Square(row - 1, col + 1);
-
-            if (validCoord(row - 1, col - 1))
-                kingAttacks[Square(row, col)] |= 1UL << Square(row - 1, col - 1);
-        }
-    }
-}
-
-constexpr void PrecomputedData::initializeKnightAttacks()
-{
-    for (int row = ROW_1; row <= ROW_8; row++)
-    {
-        for (int col = COL_A; col <= COL_H; col++)
-        {
-            if (validCoord(row + 2, col + 1))
-                knightAttacks[Square(row, col)] |= 1UL << Square(row + 2, col + 1);
-
-            if (validCoord(row + 2, col - 1))
-                knightAttacks[Square(row, col)] |= 1UL << Square(row + 2, col - 1);
-
-            if (validCoord(row - 2, col + 1))
-                knightAttacks[Square(row, col)] |= 1UL << Square(row - 2, col + 1);
-
-            if (validCoord(row - 2, col - 1))
-                knightAttacks[Square(row, col)] |= 1UL << Square(row - 2, col - 1);
-
-            if (validCoord(row + 1, col + 2))
-                knightAttacks[Square(row, col)] |= 1UL << Square(row + 1, col + 2);
-
-            if (validCoord(row + 1, col - 2))
-                knightAttacks[Square(row, col)] |= 1UL << Square(row + 1, col - 2);
-
-            if (validCoord(row - 1, col + 2))
-                knightAttacks[Square(row, col)] |= 1UL << Square(row - 1, col + 2);
-
-            if (validCoord(row - 1, col - 2))
-                knightAttacks[Square(row, col)] |= 1UL << Square(row - 1, col - 2);
-        }
-    }
-}
-
-constexpr void PrecomputedData::initializePawnAttacks()
-{
-    for (int row = ROW_1; row <= ROW_8; row++)
-    {
-        for (int col = COL_A; col <= COL_H; col++)
-        {
-            if (validCoord(row + 1, col + 1))
-                pawnWhiteAttacks[Square(row, col)] |= 1UL << Square(row + 1, col + 1);
-
-            if (validCoord(row + 1, col - 1))
-                pawnWhiteAttacks[Square(row, col)] |= 1UL << Square(row + 1, col - 1);
-
-            if (validCoord(row - 1, col + 1))
-                pawnBlackAttacks[Square(row, col)] |= 1UL << Square(row - 1, col + 1);
-
-            if (validCoord(row - 1, col - 1))
-                pawnBlackAttacks[Square(row, col)] |= 1UL << Square(row - 1, col - 1);
-        }
-    }
-}
-
-constexpr void PrecomputedData::initializeRookAttacks()
-{
-    for (int row = ROW_1; row <= ROW_8; row++)
-    {
-        for (int col = COL_A; col <= COL_H; col++)
-        {
-            int auxRow = ROW_1;
-            while (auxRow <= ROW_8)
-            {
-                if (validCoord(auxRow, col) && auxRow != row)
-                    rookAttacks[Square(row, col)] |= 1UL << Square(auxRow, col);
-
-                auxRow++;
-            }
-
-            int auxCol = COL_A;
-
-            while (auxCol <= COL_H)
-            {
-                if (validCoord(row, auxCol) && auxCol != col)
-                    rookAttacks[Square(row, col)] |= 1UL << Square(row, auxCol);
-
-                auxCol++;
-            }
-        }
-    }
-}
-constexpr void PrecomputedData::initializeBishopAttacks()
-{
-    for (int row = ROW_1; row <= ROW_8; row++)
-    {
-        for (int col = COL_A; col <= COL_H; col++)
-        {
-            int auxRow = row > col ? row - col : ROW_1;
-            int auxCol = row > col ? COL_A : col - row;
-
-            while (auxRow <= ROW_8 && auxCol <= COL_H)
-            {
-                if (row != auxRow && col != auxCol)
-                    bishopAttacks[Square(row, col)] |= 1UL << Square(auxRow, auxCol);
-
-                auxRow++;
-                auxCol++;
-            }
-
-            auxRow = (7 - row) > col ? row + col : ROW_8;
-            auxCol = (7 - row) > col ? COL_A : col - (7 - row);
-
-            while (auxRow >= ROW_1 && auxCol <= COL_H)
-            {
-                if (row != auxRow && col != auxCol)
-                    bishopAttacks[Square(row, col)] |= 1UL << Square(auxRow, auxCol);
-
-                auxRow--;
-                auxCol++;
-            }
-        }
-    }
-}
-
-constexpr void PrecomputedData::initializeQueenAttacks()
-{
-    for (Square square = SQ_A1; square <= SQ_H8; square++)
-    {
-        queenAttacks[square] = rookAttacks[square] | bishopAttacks[square];
-    }
-}
-
-void PrecomputedData::initializeRookMoves()
-{
-    for (Square square = SQ_A1; square <= SQ_H8; square++)
-    {
-        rookMoves[square] = new std::unordered_map<uint64_t, uint64_t>();
-        calculateRookMoves(square);
-    }
-}
-
-void PrecomputedData::initializeBishopMoves()
-{
-    for (Square square = SQ_A1; square <= SQ_H8; square++)
-    {
-        bishopMoves[square] = new std::unordered_map<uint64_t, uint64_t>();
-        calculateBishopMoves(square);
-    }
-}
-
-void PrecomputedData::calculateRookMoves(Square square)
-{
-    uint64_t moveMask = getRookAttacks(square);
-
-    int indicesInMoveMask[64] = {0};
-    int numIndices = 0;
-
-    // Create a list of the indices of the bits that are set to 1 in the movement mask
-    for (int i = 0; i < 64; i++)
-    {
-        if (moveMask & (1UL << i))
-        {
-            indicesInMoveMask[numIndices++] = i;
-        }
-    }
-
-    // Calculate total number of different bitboards
-    int numPatterns = 1 << numIndices; // 2^n
-
-    // Create all bitboards
-    for (int patternIndex = 0; patternIndex < numPatterns; patternIndex++)
-    {
-        // calculate blocker bitboard
-        uint64_t blockerBitboard = 0;
-        for (int bitIndex = 0; bitIndex < numIndices; bitIndex++)
-        {
-            uint64_t bit = (patternIndex >> bitIndex) & 1;
-            blockerBitboard |= bit << indicesInMoveMask[bitIndex];
-        }
-
-        // create entry in rook lookupTable
-        (*rookMoves[square])[blockerBitboard] = calculateLegalRookMoves(square, blockerBitboard);
-    }
-}
-
-void PrecomputedData::calculateBishopMoves(Square square)
-{
-    uint64_t moveMask = getBishopAttacks(square);
-
-    int indicesInMoveMask[64] = {0};
-    int numIndices = 0;
-
-    // Create a list of the indices of the bits that are set to 1 in the movement mask
-    for (int i = 0; i < 64; i++)
-    {
-        if (moveMask & (1UL << i))
-        {
-            indicesInMoveMask[numIndices++] = i;
-        }
-    }
-
-    // Calculate total number of different bitboards
-    int numPatterns = 1 << numIndices; // 2^n
-
-    // Create all bitboards
-    for (int patternIndex = 0; patternIndex < numPatterns; patternIndex++)
-    {
-        // calculate blocker bitboard
-        uint64_t blockerBitboard = 0;
-        for (int bitIndex = 0; bitIndex < numIndices; bitIndex++)
-        {
-            uint64_t bit = (patternIndex >> bitIndex) & 1;
-            blockerBitboard |= bit << indicesInMoveMask[bitIndex];
-        }
-
-        // create entry in rook lookupTable
-        (*bishopMoves[square])[blockerBitboard] = calculateLegalBishopMoves(square, blockerBitboard);
-    }
-}
-
-uint64_t PrecomputedData::calculateLegalRookMoves(Square square, uint64_t blockerBB)
-{
-    uint64_t movesBitboard = 0;
-
-    int row = square.row();
-    int col = square.col();
-
-    int rookDirections[4][2] = {
-        {1, 0},  // Up
-        {-1, 0}, // Down
-        {0, 1},  // Right
-        {0, -1}  // Left
-    };
-
-    for (int i = 0; i < 4; ++i)
-    {
-        int dirRow = rookDirections[i][0];
-        int dirCol = rookDirections[i][1];
-
-        int auxRow = row + dirRow;
-        int auxCol = col + dirCol;
-
-        while (validCoord(auxRow, auxCol))
-        {
-            Square auxSquare = Square(auxRow, auxCol);
-
-            // set the square to 1 in the bitboard
-            movesBitboard |= auxSquare.mask();
-
-            // if there is a blocker in the square we stop in this direction
-            if (blockerBB & auxSquare.mask())
-            {
-                break;
-            }
-
-            auxRow += dirRow;
-            auxCol += dirCol;
-        }
-    }
-
-    return movesBitboard;
-}
-
-uint64_t PrecomputedData::calculateLegalBishopMoves(Square square, uint64_t blockerBB)
-{
-    uint64_t movesBitboard = 0;
-
-    int row = square.row();
-    int col = square.col();
-
-    int bishopDirections[4][2] = {
-        {1, 1},  // Up-right
-        {1, -1}, // Up-left
-        {-1, 1}, // Down-right
-        {-1, -1} // Down-left
-    };
-
-    for (int i = 0; i < 4; ++i)
-    {
-        int dirRow = bishopDirections[i][0];
-        int dirCol = bishopDirections[i][1];
-
-        int auxRow = row + dirRow;
-        int auxCol = col + dirCol;
-
-        while (validCoord(auxRow, auxCol))
-        {
-            Square auxSquare = Square(auxRow, auxCol);
-
-            // set the square to 1 in the bitboard
-            movesBitboard |= auxSquare.mask();
-
-            // if there is a blocker in the square we stop in this direction
-            if (blockerBB & auxSquare.mask())
-            {
-                break;
-            }
-
-            auxRow += dirRow;
-            auxCol += dirCol;
-        }
-    }
-
-    return movesBitboard;
-}
\ No newline at end of file
+// global lookup tables, built once at process start
+extern const PrecomputedData precomputedData;
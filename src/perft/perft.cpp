@@ -0,0 +1,64 @@
+#include "perft.hpp"
+
+#include <chrono>
+
+#include "moveGenerator.hpp"
+
+uint64_t perft(Board &board, int depth)
+{
+    if (depth <= 0)
+    {
+        return 1;
+    }
+
+    MoveList moves;
+    generateLegalMoves(moves, board);
+
+    // the moves are legal, the leaf nodes can be counted without playing them
+    if (depth == 1)
+    {
+        return moves.size();
+    }
+
+    uint64_t nodes = 0;
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        board.makeMove(moves.get(i));
+        nodes += perft(board, depth - 1);
+        board.unmakeMove(moves.get(i));
+    }
+
+    return nodes;
+}
+
+uint64_t perftDivide(Board &board, int depth, std::ostream &out)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    MoveList moves;
+    generateLegalMoves(moves, board);
+
+    uint64_t nodes = 0;
+
+    for (int i = 0; i < moves.size() && depth > 0; i++)
+    {
+        board.makeMove(moves.get(i));
+        const uint64_t moveNodes = perft(board, depth - 1);
+        board.unmakeMove(moves.get(i));
+
+        nodes += moveNodes;
+
+        out << moves.get(i).toString() << ": " << moveNodes << "\n";
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+    const int64_t elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    const uint64_t nps = nodes * 1000 / (elapsedMs > 0 ? elapsedMs : 1);
+
+    out << "\nNodes searched: " << nodes << "\n"
+        << "Time: " << elapsedMs << " ms\n"
+        << "Nodes/second: " << nps << std::endl;
+
+    return nodes;
+}
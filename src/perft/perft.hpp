@@ -0,0 +1,24 @@
+#pragma once
+
+/*
+    Perft, performance test, move path enumeration
+    https://www.chessprogramming.org/Perft
+*/
+
+#include <cstdint>
+#include <ostream>
+
+#include "board.hpp"
+
+/*
+ *   Count the leaf nodes of the legal move tree of the given depth,
+ *   the moves are made and undone so the board is left unchanged
+ */
+uint64_t perft(Board &board, int depth);
+
+/*
+ *   Run perft printing the nodes of each root move (divide),
+ *   then the total nodes, the elapsed time and the nodes per second.
+ *   Return the total nodes
+ */
+uint64_t perftDivide(Board &board, int depth, std::ostream &out);
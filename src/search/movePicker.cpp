@@ -0,0 +1,197 @@
+#include "movePicker.hpp"
+
+#include "evaluation.hpp"
+
+// the captures are searched before the quiet evasions
+constexpr int EVASION_CAPTURE_BONUS = 1 << 30;
+
+MovePicker::MovePicker(const Board &board, MoveList &moves, Move ttMove, const Move killers[2], const int (&history)[64][64])
+    : board(board), moves(moves), ttMove(ttMove), killers{killers[0], killers[1]}, history(history),
+      inCheck(false), stage(PickerStage::TT_MOVE), current(0), killerIndex(0),
+      pickedKillers{Move::none(), Move::none()}, pickedKillerCount(0), badCaptureCount(0), badCaptureIndex(0)
+{
+}
+
+MovePicker::MovePicker(const Board &board, MoveList &moves, bool inCheck, const int (&history)[64][64])
+    : board(board), moves(moves), ttMove(Move::none()), killers{Move::none(), Move::none()}, history(history),
+      inCheck(inCheck), stage(PickerStage::GENERATE_NOISY), current(0), killerIndex(0),
+      pickedKillers{Move::none(), Move::none()}, pickedKillerCount(0), badCaptureCount(0), badCaptureIndex(0)
+{
+}
+
+Move MovePicker::nextMove()
+{
+    switch (stage)
+    {
+    case PickerStage::TT_MOVE:
+        stage = PickerStage::GENERATE_CAPTURES;
+
+        // the move may come from other position with the same key, it is checked before playing it
+        if (ttMove.isValid() && isLegal(board, ttMove))
+        {
+            return ttMove;
+        }
+        [[fallthrough]];
+
+    case PickerStage::GENERATE_CAPTURES:
+        generate<GenType::CAPTURES>(moves, board);
+        scoreCaptures();
+        current = 0;
+        stage = PickerStage::CAPTURES;
+        [[fallthrough]];
+
+    case PickerStage::CAPTURES:
+        while (current < moves.size())
+        {
+            const Move move = moves.pickBest(current++);
+
+            if (move == ttMove)
+            {
+                continue;
+            }
+
+            if (!board.see(move, 0))
+            {
+                badCaptures[badCaptureCount++] = move;
+                continue;
+            }
+
+            return move;
+        }
+        stage = PickerStage::KILLERS;
+        [[fallthrough]];
+
+    case PickerStage::KILLERS:
+        while (killerIndex < 2)
+        {
+            const Move killer = killers[killerIndex++];
+
+            // the killers come from sibling nodes, in this position they could be captures or illegal.
+            // En passant and promotions are generated by CAPTURES, castling is checked by isLegal
+            if (killer.isValid() && killer != ttMove && !isPickedKiller(killer) && board.empty(killer.squareTo()) &&
+                (killer.type() == MoveType::NORMAL || killer.type() == MoveType::CASTLING) && isLegal(board, killer))
+            {
+                pickedKillers[pickedKillerCount++] = killer;
+                return killer;
+            }
+        }
+        stage = PickerStage::GENERATE_QUIETS;
+        [[fallthrough]];
+
+    case PickerStage::GENERATE_QUIETS:
+        generate<GenType::QUIETS>(moves, board);
+        scoreQuiets();
+        current = 0;
+        stage = PickerStage::QUIETS;
+        [[fallthrough]];
+
+    case PickerStage::QUIETS:
+        while (current < moves.size())
+        {
+            const Move move = moves.pickBest(current++);
+
+            if (move != ttMove && !isPickedKiller(move))
+            {
+                return move;
+            }
+        }
+        stage = PickerStage::BAD_CAPTURES;
+        [[fallthrough]];
+
+    case PickerStage::BAD_CAPTURES:
+        if (badCaptureIndex < badCaptureCount)
+        {
+            return badCaptures[badCaptureIndex++];
+        }
+        stage = PickerStage::DONE;
+        return Move::none();
+
+    case PickerStage::GENERATE_NOISY:
+        if (inCheck)
+        {
+            generate<GenType::EVASIONS>(moves, board);
+            scoreEvasions();
+        }
+        else
+        {
+            generate<GenType::CAPTURES>(moves, board);
+            scoreCaptures();
+        }
+        current = 0;
+        stage = PickerStage::NOISY;
+        [[fallthrough]];
+
+    case PickerStage::NOISY:
+        if (current < moves.size())
+        {
+            return moves.pickBest(current++);
+        }
+        stage = PickerStage::DONE;
+        [[fallthrough]];
+
+    case PickerStage::DONE:
+    default:
+        return Move::none();
+    }
+}
+
+/*
+ *   Most valuable victim - least valuable attacker, promotions add the value of the new piece
+ */
+int mvvLvaScore(const Board &board, Move move)
+{
+    const PieceType victim = board.empty(move.squareTo()) ? PieceType::EMPTY : board.getPieceType(move.squareTo());
+    const PieceType attacker = board.getPieceType(move.squareFrom());
+
+    int score = move.type() == MoveType::EN_PASSANT ? 10 * pieceValue[static_cast<int>(PieceType::PAWN)]
+                                                    : 10 * pieceValue[static_cast<int>(victim)];
+
+    score -= pieceValue[static_cast<int>(attacker)] / 10;
+
+    if (move.type() == MoveType::PROMOTION)
+    {
+        score += pieceValue[static_cast<int>(move.promotionPiece())];
+    }
+
+    return score;
+}
+
+void MovePicker::scoreCaptures()
+{
+    for (int i = 0; i < moves.size(); i++)
+    {
+        moves.setScore(i, mvvLvaScore(board, moves.get(i)));
+    }
+}
+
+void MovePicker::scoreQuiets()
+{
+    for (int i = 0; i < moves.size(); i++)
+    {
+        const Move move = moves.get(i);
+        moves.setScore(i, history[move.squareFrom()][move.squareTo()]);
+    }
+}
+
+void MovePicker::scoreEvasions()
+{
+    scoreCaptures();
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        const Move move = moves.get(i);
+        const bool isCapture = !board.empty(move.squareTo()) || move.type() == MoveType::EN_PASSANT ||
+                               move.type() == MoveType::PROMOTION;
+
+        moves.setScore(i, isCapture ? moves.getScore(i) + EVASION_CAPTURE_BONUS : history[move.squareFrom()][move.squareTo()]);
+    }
+}
+
+/*
+ *   Return true if the move was returned by the KILLERS stage,
+ *   the killers rejected there are returned with the rest of the quiet moves
+ */
+bool MovePicker::isPickedKiller(Move move) const
+{
+    return (pickedKillerCount > 0 && move == pickedKillers[0]) || (pickedKillerCount > 1 && move == pickedKillers[1]);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+/*
+    Staged move generation, the moves are generated and returned in stages
+    so the nodes with an early beta cutoff do not pay for the whole generation
+    https://www.chessprogramming.org/Move_Generation#Staged_Move_Generation
+*/
+
+#include "board.hpp"
+#include "moveGenerator.hpp"
+
+/*
+ *   TT_MOVE: best move stored in the transposition table
+ *   CAPTURES: captures and promotions, most valuable victim - least valuable attacker,
+ *             the captures that lose material by static exchange evaluation are left for BAD_CAPTURES
+ *   KILLERS: quiet moves and castling that caused a beta cutoff in sibling nodes
+ *   QUIETS: the rest of the moves, ordered by history
+ *   BAD_CAPTURES: losing captures, in the order of CAPTURES
+ *
+ *   The quiescence search only uses the GENERATE_NOISY and NOISY stages:
+ *   captures and promotions, or all the evasions if the side to move is in check.
+ */
+enum class PickerStage
+{
+    TT_MOVE,
+    GENERATE_CAPTURES,
+    CAPTURES,
+    KILLERS,
+    GENERATE_QUIETS,
+    QUIETS,
+    BAD_CAPTURES,
+    GENERATE_NOISY,
+    NOISY,
+    DONE
+};
+
+// score of the capture or promotion in the CAPTURES stage
+int mvvLvaScore(const Board &board, Move move);
+
+class MovePicker
+{
+public:
+    /*
+     *   moves is the list used to generate the stages, it should not be modified while picking.
+     *   history is the history table of the side to move, indexed by [from][to]
+     */
+    MovePicker(const Board &board, MoveList &moves, Move ttMove, const Move killers[2], const int (&history)[64][64]);
+
+    /*
+     *   Quiescence search picker, captures ordered by most valuable victim - least valuable attacker.
+     *   In check all the evasions are returned, the quiet ones after the captures ordered by history
+     */
+    MovePicker(const Board &board, MoveList &moves, bool inCheck, const int (&history)[64][64]);
+
+    ~MovePicker() {}
+
+    // return the next move to search, Move::none() when there are no more moves
+    Move nextMove();
+
+private:
+    const Board &board;
+    MoveList &moves;
+    const Move ttMove;
+    const Move killers[2];
+    const int (&history)[64][64];
+
+    const bool inCheck;
+
+    PickerStage stage;
+    int current;
+    int killerIndex;
+
+    // killers returned by the KILLERS stage, skipped in QUIETS
+    Move pickedKillers[2];
+    int pickedKillerCount;
+
+    // losing captures found in the CAPTURES stage
+    Move badCaptures[MAX_MOVES];
+    int badCaptureCount;
+    int badCaptureIndex;
+
+    void scoreCaptures();
+    void scoreQuiets();
+    void scoreEvasions();
+    bool isPickedKiller(Move move) const;
+};
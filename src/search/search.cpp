@@ -0,0 +1,525 @@
+#include "search.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "evaluation.hpp"
+#include "movePicker.hpp"
+#include "nnue.hpp"
+#include "threadPool.hpp"
+#include "transpositionTable.hpp"
+
+// avoids the overflow of the history scores in long searches
+constexpr int MAX_HISTORY_SCORE = 1 << 28;
+
+// the main worker checks the time and the nodes every 1024 nodes
+constexpr uint64_t CHECK_LIMITS_MASK = 1023;
+
+/*
+ *   Mate scores are stored in the transposition table relative to the node,
+ *   not to the root, so they are valid when the node is reached from other paths
+ */
+static inline int scoreToTT(int score, int ply)
+{
+    return score >= MATE_IN_MAX_PLY ? score + ply : score <= -MATE_IN_MAX_PLY ? score - ply : score;
+}
+
+static inline int scoreFromTT(int score, int ply)
+{
+    return score >= MATE_IN_MAX_PLY ? score - ply : score <= -MATE_IN_MAX_PLY ? score + ply : score;
+}
+
+int64_t allocateTime(const SearchLimits &limits, Color sideToMove)
+{
+    if (limits.infinite)
+    {
+        return 0;
+    }
+
+    if (limits.movetime > 0)
+    {
+        return std::max<int64_t>(limits.movetime - MOVE_OVERHEAD_MS, 1);
+    }
+
+    const int64_t time = limits.time[static_cast<int>(sideToMove)];
+    const int64_t inc = limits.inc[static_cast<int>(sideToMove)];
+
+    if (time <= 0)
+    {
+        return 0;
+    }
+
+    // an equal part of the remaining time for each move left, plus most of the increment
+    const int movesToGo = limits.movestogo > 0 ? limits.movestogo : DEFAULT_MOVES_TO_GO;
+    const int64_t budget = time / movesToGo + inc * 3 / 4;
+
+    return std::clamp<int64_t>(budget, 1, std::max<int64_t>(time - MOVE_OVERHEAD_MS, 1));
+}
+
+void SearchWorker::reset(const Board &rootBoard)
+{
+    board = rootBoard;
+    nodes.store(0, std::memory_order_relaxed);
+    rootBestMove = Move::none();
+    bestScore = -INFINITE_SCORE;
+    completedDepth = 0;
+    bestPvLength = 0;
+    selDepth = 0;
+    accumulators.reset();
+    timeLimitMs = allocateTime(pool.limits, rootBoard.sideToMove);
+    std::memset(history, 0, sizeof(history));
+
+    // reported if the search is stopped before the first iteration finishes, none without legal moves
+    MoveList rootMoves;
+    generateLegalMoves(rootMoves, board);
+    bestMove = rootMoves.size() > 0 ? rootMoves.get(0) : Move::none();
+
+    for (int ply = 0; ply < MAX_PLY; ply++)
+    {
+        killers[ply][0] = killers[ply][1] = Move::none();
+    }
+}
+
+void SearchWorker::search()
+{
+    // helper threads start on different depths so they do not search the same tree at the same time
+    const int startDepth = 1 + (isMainWorker() ? 0 : id % 2);
+    const int maxDepth = isMainWorker() ? pool.limits.depth : MAX_PLY - 1;
+
+    for (int depth = startDepth; depth <= maxDepth; depth++)
+    {
+        selDepth = 0;
+
+        const int score = aspirationSearch(depth, bestScore);
+
+        // the result of an interrupted iteration is not reliable
+        if (pool.stop.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        bestMove = rootBestMove;
+        bestScore = score;
+        completedDepth = depth;
+
+        // the table is overwritten by the next iteration
+        bestPvLength = pvLength[0];
+        std::copy(pvTable[0], pvTable[0] + bestPvLength, bestPv);
+
+        if (isMainWorker())
+        {
+            if (pool.isVerbose())
+            {
+                printInfo(depth, score);
+            }
+
+            // the next iteration takes longer than all the previous ones, it would not finish in time
+            if (timeLimitMs > 0 && pool.limits.movetime == 0 && pool.elapsedMs() >= timeLimitMs / 2)
+            {
+                break;
+            }
+        }
+    }
+
+    if (isMainWorker())
+    {
+        // in infinite mode the best move is reported only after the stop command
+        while (pool.limits.infinite && !pool.stop.load(std::memory_order_relaxed))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // the helpers search without depth limit, they stop when the main thread finishes
+        pool.stopSearch();
+        pool.waitForHelpers();
+
+        if (pool.isVerbose())
+        {
+            // the uci null move is reported in the positions without legal moves
+            std::cout << "bestmove " + (bestMove == Move::none() ? std::string("0000") : bestMove.toString()) + "\n" << std::flush;
+        }
+    }
+}
+
+/*
+ *   Search the root with a narrow window around the score of the previous iteration,
+ *   most of the time the score stays inside and the window produces more cutoffs.
+ *   When the score falls outside the window is widened on that side and the root searched again.
+ */
+int SearchWorker::aspirationSearch(int depth, int previousScore)
+{
+    if (depth < ASPIRATION_MIN_DEPTH || previousScore >= MATE_IN_MAX_PLY || previousScore <= -MATE_IN_MAX_PLY)
+    {
+        return alphaBeta(depth, 0, -INFINITE_SCORE, INFINITE_SCORE);
+    }
+
+    int delta = ASPIRATION_WINDOW;
+    int alpha = std::max(previousScore - delta, -INFINITE_SCORE);
+    int beta = std::min(previousScore + delta, INFINITE_SCORE);
+
+    while (true)
+    {
+        const int score = alphaBeta(depth, 0, alpha, beta);
+
+        if (pool.stop.load(std::memory_order_relaxed))
+        {
+            return score;
+        }
+
+        if (score <= alpha)
+        {
+            alpha = std::max(score - delta, -INFINITE_SCORE);
+        }
+        else if (score >= beta)
+        {
+            beta = std::min(score + delta, INFINITE_SCORE);
+        }
+        else
+        {
+            return score;
+        }
+
+        delta *= 2;
+    }
+}
+
+/*
+ *   Principal variation search, the first move is searched with the full window
+ *   and the rest with a null window that only proves they are not better.
+ *   A move that fails high on the null window is searched again with the full window.
+ */
+int SearchWorker::alphaBeta(int depth, int ply, int alpha, int beta)
+{
+    pvLength[ply] = ply;
+
+    if (ply > 0 && pool.stop.load(std::memory_order_relaxed))
+    {
+        return 0;
+    }
+
+    if (depth <= 0)
+    {
+        return quiescence(ply, alpha, beta);
+    }
+
+    const uint64_t nodeCount = nodes.load(std::memory_order_relaxed) + 1;
+    nodes.store(nodeCount, std::memory_order_relaxed);
+
+    if (isMainWorker() && (nodeCount & CHECK_LIMITS_MASK) == 0)
+    {
+        checkLimits();
+    }
+
+    selDepth = std::max(selDepth, ply);
+
+    if (ply >= MAX_PLY - 1)
+    {
+        return evaluatePosition();
+    }
+
+    // fifty moves rule and repetitions of the game or the search path
+    if (ply > 0 && (board.halfmove >= 100 || board.isRepetition()))
+    {
+        return 0;
+    }
+
+    const bool pvNode = beta - alpha > 1;
+    const int originalAlpha = alpha;
+    const uint64_t key = board.zobristKey;
+
+    TTData ttData;
+    Move ttMove = Move::none();
+
+    if (transpositionTable.probe(key, ttData))
+    {
+        ttMove = ttData.move;
+
+        // the cutoffs in pv nodes would cut the principal variation
+        if (!pvNode && ttData.depth >= depth)
+        {
+            const int ttScore = scoreFromTT(ttData.score, ply);
+
+            if (ttData.nodeType == NodeType::EXACT ||
+                (ttData.nodeType == NodeType::LOWER_BOUND && ttScore >= beta) ||
+                (ttData.nodeType == NodeType::UPPER_BOUND && ttScore <= alpha))
+            {
+                return ttScore;
+            }
+        }
+    }
+
+    MovePicker movePicker(board, moveStack[ply], ttMove, killers[ply], history[static_cast<int>(board.sideToMove)]);
+
+    int bestScore = -INFINITE_SCORE;
+    Move bestMove = Move::none();
+    int legalMoves = 0;
+    Move move;
+
+    while ((move = movePicker.nextMove()) != Move::none())
+    {
+        const bool isQuiet = board.empty(move.squareTo()) && move.type() != MoveType::EN_PASSANT &&
+                             move.type() != MoveType::PROMOTION;
+
+        legalMoves++;
+
+        board.makeMove(move);
+        accumulators.push(board);
+
+        int score;
+
+        if (legalMoves == 1)
+        {
+            score = -alphaBeta(depth - 1, ply + 1, -beta, -alpha);
+        }
+        else
+        {
+            score = -alphaBeta(depth - 1, ply + 1, -alpha - 1, -alpha);
+
+            if (score > alpha && score < beta)
+            {
+                score = -alphaBeta(depth - 1, ply + 1, -beta, -alpha);
+            }
+        }
+
+        board.unmakeMove(move);
+        accumulators.pop();
+
+        if (pool.stop.load(std::memory_order_relaxed))
+        {
+            return 0;
+        }
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = move;
+
+            if (score > alpha)
+            {
+                alpha = score;
+                updatePv(move, ply);
+
+                if (ply == 0)
+                {
+                    rootBestMove = move;
+                }
+            }
+        }
+
+        if (alpha >= beta)
+        {
+            if (isQuiet)
+            {
+                updateQuietStats(move, depth, ply);
+            }
+            break;
+        }
+    }
+
+    if (legalMoves == 0)
+    {
+        // checkmate or stalemate
+        return inCheck(board) ? -MATE_SCORE + ply : 0;
+    }
+
+    const NodeType nodeType = bestScore >= beta            ? NodeType::LOWER_BOUND
+                              : bestScore > originalAlpha ? NodeType::EXACT
+                                                          : NodeType::UPPER_BOUND;
+
+    transpositionTable.store(key, bestMove, scoreToTT(bestScore, ply), depth, nodeType);
+
+    return bestScore;
+}
+
+/*
+ *   Search only the captures and promotions until the position is quiet, so the
+ *   static evaluation is not taken in the middle of an exchange.
+ *   When the side to move is in check all the evasions are searched.
+ *   https://www.chessprogramming.org/Quiescence_Search
+ */
+int SearchWorker::quiescence(int ply, int alpha, int beta)
+{
+    // the principal variation ends at the quiescence search
+    pvLength[ply] = ply;
+
+    if (pool.stop.load(std::memory_order_relaxed))
+    {
+        return 0;
+    }
+
+    const uint64_t nodeCount = nodes.load(std::memory_order_relaxed) + 1;
+    nodes.store(nodeCount, std::memory_order_relaxed);
+
+    if (isMainWorker() && (nodeCount & CHECK_LIMITS_MASK) == 0)
+    {
+        checkLimits();
+    }
+
+    selDepth = std::max(selDepth, ply);
+
+    if (ply >= MAX_PLY - 1)
+    {
+        return evaluatePosition();
+    }
+
+    const bool isInCheck = inCheck(board);
+    int bestScore = -INFINITE_SCORE;
+
+    // stand pat, the side to move is not forced to capture
+    if (!isInCheck)
+    {
+        bestScore = evaluatePosition();
+
+        if (bestScore >= beta)
+        {
+            return bestScore;
+        }
+
+        alpha = std::max(alpha, bestScore);
+    }
+
+    MovePicker movePicker(board, moveStack[ply], isInCheck, history[static_cast<int>(board.sideToMove)]);
+    Move move;
+
+    while ((move = movePicker.nextMove()) != Move::none())
+    {
+        // the captures that lose material can not raise the stand pat score
+        if (!isInCheck && !board.see(move, 0))
+        {
+            continue;
+        }
+
+        board.makeMove(move);
+        accumulators.push(board);
+        const int score = -quiescence(ply + 1, -beta, -alpha);
+        board.unmakeMove(move);
+        accumulators.pop();
+
+        if (pool.stop.load(std::memory_order_relaxed))
+        {
+            return 0;
+        }
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+
+            if (score > alpha)
+            {
+                alpha = score;
+            }
+        }
+
+        if (alpha >= beta)
+        {
+            break;
+        }
+    }
+
+    // in check without evasions
+    if (bestScore == -INFINITE_SCORE)
+    {
+        return -MATE_SCORE + ply;
+    }
+
+    return bestScore;
+}
+
+/*
+ *   The quiet move caused a beta cutoff, it is tried early in the sibling nodes (killer)
+ *   and in the rest of the search (history)
+ */
+void SearchWorker::updateQuietStats(Move move, int depth, int ply)
+{
+    int &entry = history[static_cast<int>(board.sideToMove)][move.squareFrom()][move.squareTo()];
+    entry = std::min(entry + depth * depth, MAX_HISTORY_SCORE);
+
+    if (killers[ply][0] != move)
+    {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+}
+
+/*
+ *   Score of the position from the side to move perspective, from the network if it is loaded
+ */
+int SearchWorker::evaluatePosition()
+{
+    if (!network.isLoaded())
+    {
+        return evaluate(board, pawnTable);
+    }
+
+    // the network output is not bounded, it should not be confused with a mate score
+    return std::clamp(accumulators.evaluate(board), -MATE_IN_MAX_PLY + 1, MATE_IN_MAX_PLY - 1);
+}
+
+/*
+ *   The move is the new best move of the node, its line is the move followed by the line of the child
+ */
+void SearchWorker::updatePv(Move move, int ply)
+{
+    pvTable[ply][ply] = move;
+
+    for (int i = ply + 1; i < pvLength[ply + 1]; i++)
+    {
+        pvTable[ply][i] = pvTable[ply + 1][i];
+    }
+
+    pvLength[ply] = std::max(pvLength[ply + 1], ply + 1);
+}
+
+/*
+ *   Stop the search when the time or the nodes of the go command are exhausted.
+ *   The first iteration always finishes, so there is a best move to report.
+ */
+void SearchWorker::checkLimits()
+{
+    if (completedDepth == 0 || pool.limits.infinite)
+    {
+        return;
+    }
+
+    if ((timeLimitMs > 0 && pool.elapsedMs() >= timeLimitMs) ||
+        (pool.limits.nodes > 0 && pool.nodesSearched() >= pool.limits.nodes))
+    {
+        pool.stopSearch();
+    }
+}
+
+void SearchWorker::printInfo(int depth, int score) const
+{
+    const uint64_t totalNodes = pool.nodesSearched();
+    const int64_t elapsedMs = pool.elapsedMs();
+    std::ostringstream info;
+
+    info << "info depth " << depth << " seldepth " << std::max(selDepth, depth);
+
+    if (score >= MATE_IN_MAX_PLY)
+        info << " score mate " << (MATE_SCORE - score + 1) / 2;
+    else if (score <= -MATE_IN_MAX_PLY)
+        info << " score mate " << -(MATE_SCORE + score) / 2;
+    else
+        info << " score cp " << score;
+
+    info << " nodes " << totalNodes
+         << " nps " << totalNodes * 1000 / (elapsedMs > 0 ? elapsedMs : 1)
+         << " time " << elapsedMs
+         << " hashfull " << transpositionTable.hashfull()
+         << " pv";
+
+    for (int i = 0; i < bestPvLength; i++)
+    {
+        info << " " << bestPv[i].toString();
+    }
+
+    info << "\n";
+
+    // one write for the whole line, the uci thread may be printing at the same time
+    std::cout << info.str() << std::flush;
+}
@@ -0,0 +1,139 @@
+#pragma once
+
+/*
+    Alpha-Beta search
+    https://www.chessprogramming.org/Alpha-Beta
+
+    Iterative deepening principal variation search with aspiration windows
+    https://www.chessprogramming.org/Principal_Variation_Search
+    https://www.chessprogramming.org/Aspiration_Windows
+*/
+
+#include <atomic>
+#include <cstdint>
+
+#include "board.hpp"
+#include "moveGenerator.hpp"
+#include "nnue.hpp"
+#include "pawnTable.hpp"
+
+// max depth of the search tree
+#define MAX_PLY 128
+
+constexpr int INFINITE_SCORE = 32001;
+constexpr int MATE_SCORE = 32000;
+
+static_assert(MAX_PLY < NNUE_STACK_SIZE, "the accumulator stack should have an entry for each ply");
+
+// scores above this value are mate in some plies
+constexpr int MATE_IN_MAX_PLY = MATE_SCORE - MAX_PLY;
+
+// first depth searched with an aspiration window and its initial half width
+constexpr int ASPIRATION_MIN_DEPTH = 4;
+constexpr int ASPIRATION_WINDOW = 25;
+
+// time reserved for the communication with the gui in each move
+constexpr int64_t MOVE_OVERHEAD_MS = 30;
+
+// moves left in the game assumed when the gui does not send movestogo
+constexpr int DEFAULT_MOVES_TO_GO = 30;
+
+/*
+ *   Limits of the search received in the go command, 0 means no limit
+ */
+struct SearchLimits
+{
+    int depth = MAX_PLY - 1;
+    uint64_t nodes = 0;
+    int64_t movetime = 0;
+    int64_t time[2] = {0, 0}; // remaining time of each color, wtime and btime
+    int64_t inc[2] = {0, 0};  // increment of each color, winc and binc
+    int movestogo = 0;
+    bool infinite = false; // search until the stop command
+};
+
+// milliseconds the side to move can use for the search, 0 if the time is not limited
+int64_t allocateTime(const SearchLimits &limits, Color sideToMove);
+
+class ThreadPool;
+
+/*
+ *   Search state of one thread, each worker has its own board,
+ *   move lists and history table, only the transposition table is shared.
+ */
+class SearchWorker
+{
+public:
+    SearchWorker(int id, ThreadPool &pool) : id(id), pool(pool) {}
+
+    ~SearchWorker() {}
+
+    // prepare the worker to search the position
+    void reset(const Board &rootBoard);
+
+    // iterative deepening loop, the worker 0 reports the progress and the best move
+    void search();
+
+    inline uint64_t getNodes() const { return nodes.load(std::memory_order_relaxed); }
+    inline Move getBestMove() const { return bestMove; }
+    inline int getBestScore() const { return bestScore; }
+    inline int getCompletedDepth() const { return completedDepth; }
+
+    // the pawn table is kept between searches, its counters show the hit rate of all of them
+    inline const PawnTable &getPawnTable() const { return pawnTable; }
+
+private:
+    const int id;
+    ThreadPool &pool;
+
+    Board board;
+    MoveList moveStack[MAX_PLY];
+
+    // first layer of the network in each ply of the search path
+    AccumulatorStack accumulators;
+
+    // pawn structures evaluated by this thread
+    PawnTable pawnTable;
+
+    // quiet moves that caused a beta cutoff, indexed by [color][from][to]
+    int history[2][64][64];
+
+    // last two quiet moves that caused a beta cutoff in each ply
+    Move killers[MAX_PLY][2];
+
+    // written only by the worker thread, read by other threads for reporting
+    std::atomic<uint64_t> nodes;
+
+    /*
+     *   Triangular principal variation table, pvTable[ply] has the best line
+     *   found from the node at ply, from pvTable[ply][ply] to pvTable[ply][pvLength[ply] - 1]
+     */
+    Move pvTable[MAX_PLY + 1][MAX_PLY + 1];
+    int pvLength[MAX_PLY + 1];
+
+    // principal variation of the last completed iteration
+    Move bestPv[MAX_PLY + 1];
+    int bestPvLength;
+
+    Move rootBestMove;
+    Move bestMove;
+    int bestScore;
+    int completedDepth;
+
+    // deepest ply reached in the current iteration
+    int selDepth;
+
+    // time limit of the search in milliseconds, only checked by the main worker
+    int64_t timeLimitMs;
+
+    int aspirationSearch(int depth, int previousScore);
+    int alphaBeta(int depth, int ply, int alpha, int beta);
+    int quiescence(int ply, int alpha, int beta);
+    void updateQuietStats(Move move, int depth, int ply);
+    void updatePv(Move move, int ply);
+    int evaluatePosition();
+    void checkLimits();
+    void printInfo(int depth, int score) const;
+
+    inline bool isMainWorker() const { return id == 0; }
+};
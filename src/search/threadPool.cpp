@@ -0,0 +1,129 @@
+#include "threadPool.hpp"
+
+#include <algorithm>
+
+#include "transpositionTable.hpp"
+
+SearchThread::SearchThread(int id, ThreadPool &pool)
+    : worker(id, pool), searching(true), exit(false), thread(&SearchThread::idleLoop, this)
+{
+    // wait until the thread is idle
+    waitForSearchFinished();
+}
+
+SearchThread::~SearchThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exit = true;
+        searching = true;
+    }
+    cv.notify_one();
+    thread.join();
+}
+
+void SearchThread::startSearching()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        searching = true;
+    }
+    cv.notify_one();
+}
+
+void SearchThread::waitForSearchFinished()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [this]
+            { return !searching; });
+}
+
+void SearchThread::idleLoop()
+{
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        searching = false;
+        cv.notify_one(); // wake up waitForSearchFinished()
+        cv.wait(lock, [this]
+                { return searching; });
+
+        if (exit)
+        {
+            return;
+        }
+
+        lock.unlock();
+
+        worker.search();
+    }
+}
+
+void ThreadPool::setThreads(int threadCount)
+{
+    threadCount = std::clamp(threadCount, MIN_THREADS, MAX_THREADS);
+
+    threads.clear();
+
+    for (int id = 0; id < threadCount; id++)
+    {
+        threads.push_back(std::make_unique<SearchThread>(id, *this));
+    }
+}
+
+void ThreadPool::startSearch(const Board &board, const SearchLimits &searchLimits)
+{
+    waitForSearchFinished();
+
+    limits = searchLimits;
+    startTime = std::chrono::steady_clock::now();
+    stop.store(false, std::memory_order_relaxed);
+
+    if (newGenerationPerSearch)
+    {
+        transpositionTable.newSearch();
+    }
+
+    for (auto &thread : threads)
+    {
+        thread->worker.reset(board);
+    }
+
+    // the helpers first, the main thread waits for them when it finishes
+    for (std::size_t i = 1; i < threads.size(); i++)
+    {
+        threads[i]->startSearching();
+    }
+
+    threads[0]->startSearching();
+}
+
+void ThreadPool::waitForSearchFinished()
+{
+    threads[0]->waitForSearchFinished();
+}
+
+void ThreadPool::waitForHelpers()
+{
+    for (std::size_t i = 1; i < threads.size(); i++)
+    {
+        threads[i]->waitForSearchFinished();
+    }
+}
+
+uint64_t ThreadPool::nodesSearched() const
+{
+    uint64_t nodes = 0;
+
+    for (const auto &thread : threads)
+    {
+        nodes += thread->worker.getNodes();
+    }
+
+    return nodes;
+}
+
+int64_t ThreadPool::elapsedMs() const
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+/*
+    Lazy SMP, all the threads search the same position sharing the transposition table
+    https://www.chessprogramming.org/Lazy_SMP
+*/
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "search.hpp"
+
+#define MIN_THREADS 1
+#define MAX_THREADS 1024
+
+/*
+ *   Thread that waits idle until a search is requested
+ */
+class SearchThread
+{
+public:
+    SearchThread(int id, ThreadPool &pool);
+
+    // wait the search to finish and join the thread
+    ~SearchThread();
+
+    void startSearching();
+    void waitForSearchFinished();
+
+    SearchWorker worker;
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool searching;
+    bool exit;
+    std::thread thread;
+
+    void idleLoop();
+};
+
+class ThreadPool
+{
+public:
+    ThreadPool() : stop(false), verbose(true), newGenerationPerSearch(true) { setThreads(MIN_THREADS); }
+
+    ~ThreadPool() {}
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // create the threads, should not be called while searching
+    void setThreads(int threadCount);
+
+    inline int size() const { return static_cast<int>(threads.size()); }
+
+    // start the search of the position on all the threads
+    void startSearch(const Board &board, const SearchLimits &searchLimits);
+
+    // wait until the main thread reports the best move
+    void waitForSearchFinished();
+
+    // signal the threads to stop as soon as possible
+    inline void stopSearch() { stop.store(true, std::memory_order_relaxed); }
+
+    // used by the main thread to wait the helpers before reporting the best move
+    void waitForHelpers();
+
+    // the worker of the main thread has the result of the last search
+    inline const SearchWorker &mainWorker() const { return threads[0]->worker; }
+
+    // total nodes searched by all the threads
+    uint64_t nodesSearched() const;
+
+    // milliseconds since the start of the search
+    int64_t elapsedMs() const;
+
+    // if false the main thread does not print info and bestmove
+    inline void setVerbose(bool value) { verbose = value; }
+    inline bool isVerbose() const { return verbose; }
+
+    /*
+     *   if false startSearch does not start a new generation of the transposition table,
+     *   used when many pools share the table and the caller starts the generation once
+     */
+    inline void setNewGenerationPerSearch(bool value) { newGenerationPerSearch = value; }
+
+    SearchLimits limits;
+    std::atomic<bool> stop;
+
+private:
+    std::vector<std::unique_ptr<SearchThread>> threads;
+    std::chrono::steady_clock::time_point startTime;
+    bool verbose;
+    bool newGenerationPerSearch;
+};
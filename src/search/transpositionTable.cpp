@@ -0,0 +1,163 @@
+#include "transpositionTable.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+TranspositionTable transpositionTable;
+
+/*
+ *   Entries are read and written by many threads at the same time,
+ *   relaxed atomic access compiles to plain loads and stores.
+ */
+static inline uint64_t atomicLoad(const uint64_t &value)
+{
+    return std::atomic_ref<const uint64_t>(value).load(std::memory_order_relaxed);
+}
+
+static inline void atomicStore(uint64_t &value, uint64_t newValue)
+{
+    std::atomic_ref<uint64_t>(value).store(newValue, std::memory_order_relaxed);
+}
+
+static inline uint64_t packData(Move move, int score, int depth, NodeType nodeType, uint8_t age)
+{
+    return static_cast<uint64_t>(move.raw()) |
+           static_cast<uint64_t>(static_cast<uint16_t>(static_cast<int16_t>(score))) << 16 |
+           static_cast<uint64_t>(static_cast<uint8_t>(std::clamp(depth, 0, 255))) << 32 |
+           static_cast<uint64_t>(nodeType) << 40 |
+           static_cast<uint64_t>(age) << 42;
+}
+
+static inline Move dataMove(uint64_t data) { return Move(static_cast<uint16_t>(data)); }
+static inline int dataScore(uint64_t data) { return static_cast<int16_t>(data >> 16); }
+static inline int dataDepth(uint64_t data) { return static_cast<uint8_t>(data >> 32); }
+static inline NodeType dataNodeType(uint64_t data) { return static_cast<NodeType>((data >> 40) & 0b11); }
+static inline uint8_t dataAge(uint64_t data) { return (data >> 42) & 0x3F; }
+
+void TranspositionTable::resize(std::size_t sizeMB, int threads)
+{
+    sizeMB = std::clamp<std::size_t>(sizeMB, TT_MIN_SIZE_MB, TT_MAX_SIZE_MB);
+
+    const std::size_t newBucketCount = sizeMB * 1024 * 1024 / sizeof(TTBucket);
+    // the buckets are trivial, the allocation does not initialize them
+    static_assert(std::is_trivially_default_constructible_v<TTBucket>);
+    // if the allocation throws the previous table is kept
+    std::unique_ptr<TTBucket[]> newBuckets(new TTBucket[newBucketCount]);
+
+    buckets = std::move(newBuckets);
+    bucketCount = newBucketCount;
+
+    clear(threads);
+}
+
+void TranspositionTable::clear(int threads)
+{
+    threads = std::max(threads, 1);
+
+    const std::size_t chunk = (bucketCount + threads - 1) / threads;
+    std::vector<std::thread> workers;
+
+    for (int i = 0; i < threads; i++)
+    {
+        const std::size_t start = std::min(bucketCount, i * chunk);
+        const std::size_t count = std::min(bucketCount - start, chunk);
+
+        workers.emplace_back([this, start, count]()
+                             { std::memset(static_cast<void *>(&buckets[start]), 0, count * sizeof(TTBucket)); });
+    }
+
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    age.store(0, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::probe(uint64_t key, TTData &ttData) const
+{
+    const TTBucket &b = bucket(key);
+
+    for (const TTEntry &entry : b.entries)
+    {
+        const uint64_t data = atomicLoad(entry.data);
+
+        if ((atomicLoad(entry.keyXorData) ^ data) == key && dataNodeType(data) != NodeType::NONE)
+        {
+            ttData.move = dataMove(data);
+            ttData.score = dataScore(data);
+            ttData.depth = dataDepth(data);
+            ttData.nodeType = dataNodeType(data);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ *   Replacement policy:
+ *   1. the entry of the same position is always overwritten, keeping its move if the new one is none
+ *   2. otherwise the entry with the lowest depth is replaced,
+ *      entries of old searches count as shallower the older they are
+ */
+void TranspositionTable::store(uint64_t key, Move move, int score, int depth, NodeType nodeType)
+{
+    TTBucket &b = bucket(key);
+    TTEntry *replace = &b.entries[0];
+    int replaceWorth = INT32_MAX;
+    const uint8_t currentAge = age.load(std::memory_order_relaxed);
+
+    for (TTEntry &entry : b.entries)
+    {
+        const uint64_t data = atomicLoad(entry.data);
+
+        if ((atomicLoad(entry.keyXorData) ^ data) == key)
+        {
+            if (move == Move::none())
+            {
+                move = dataMove(data);
+            }
+
+            replace = &entry;
+            break;
+        }
+
+        // age distance with wrap around of the 6 bits generation
+        const int ageDistance = (currentAge - dataAge(data)) & 0x3F;
+        const int worth = dataNodeType(data) == NodeType::NONE ? -1 : dataDepth(data) - 8 * ageDistance;
+
+        if (worth < replaceWorth)
+        {
+            replaceWorth = worth;
+            replace = &entry;
+        }
+    }
+
+    const uint64_t data = packData(move, score, depth, nodeType, currentAge);
+
+    atomicStore(replace->data, data);
+    atomicStore(replace->keyXorData, key ^ data);
+}
+
+int TranspositionTable::hashfull() const
+{
+    const std::size_t samples = std::min<std::size_t>(bucketCount, 1000 / TT_BUCKET_SIZE);
+    const uint8_t currentAge = age.load(std::memory_order_relaxed);
+    int used = 0;
+
+    for (std::size_t i = 0; i < samples; i++)
+    {
+        for (const TTEntry &entry : buckets[i].entries)
+        {
+            const uint64_t data = atomicLoad(entry.data);
+            used += dataNodeType(data) != NodeType::NONE && dataAge(data) == currentAge;
+        }
+    }
+
+    return used * 1000 / (samples * TT_BUCKET_SIZE);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+/*
+    Transposition table shared by all the search threads
+    https://www.chessprogramming.org/Transposition_Table
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "move.hpp"
+
+#define TT_DEFAULT_SIZE_MB 16
+#define TT_MIN_SIZE_MB 1
+#define TT_MAX_SIZE_MB 65536
+
+/*
+ *   Kind of score stored in the entry
+ *
+ *   EXACT: the score is exact, the node was searched inside the window
+ *   LOWER_BOUND: the search failed high, the score is at least this value
+ *   UPPER_BOUND: the search failed low, the score is at most this value
+ */
+enum class NodeType : uint8_t
+{
+    NONE = 0,
+    EXACT = 1,
+    LOWER_BOUND = 2,
+    UPPER_BOUND = 3
+};
+
+/*
+ *   Unpacked content of an entry
+ */
+struct TTData
+{
+    Move move;
+    int score;
+    int depth;
+    NodeType nodeType;
+};
+
+/*
+ *   Entry of 16 bytes, the key is stored xor the data so a reader never
+ *   accepts data written by other thread for a different position, a torn
+ *   entry just fails the key verification. This way the table works without locks.
+ *
+ *   data bits:
+ *   bit  0-15: move
+ *   bit 16-31: score (int16)
+ *   bit 32-39: depth (uint8)
+ *   bit 40-41: node type
+ *   bit 42-47: age, search generation that wrote the entry
+ */
+struct TTEntry
+{
+    uint64_t keyXorData;
+    uint64_t data;
+};
+
+// 4 entries fit in a cache line, a probe touches only one line
+#define TT_BUCKET_SIZE 4
+
+struct alignas(64) TTBucket
+{
+    TTEntry entries[TT_BUCKET_SIZE];
+};
+
+class TranspositionTable
+{
+public:
+    TranspositionTable() : buckets(nullptr), bucketCount(0), age(0) { resize(TT_DEFAULT_SIZE_MB); }
+
+    ~TranspositionTable() {}
+
+    TranspositionTable(const TranspositionTable &) = delete;
+    TranspositionTable &operator=(const TranspositionTable &) = delete;
+
+    /*
+     *   Allocate sizeMB megabytes for the table, the new memory is only cleared once,
+     *   the work is split among the threads. Should not be called while searching.
+     *   Throw std::bad_alloc if the memory can not be allocated, the previous table is kept
+     */
+    void resize(std::size_t sizeMB, int threads = 1);
+
+    /*
+     *   Remove all the entries, the work is split among the threads.
+     *   Should not be called while searching.
+     */
+    void clear(int threads);
+
+    /*
+     *   Start a new search generation, entries of old searches are replaced first.
+     *   The age has 6 bits, the batch analysis starts a single generation for all its positions
+     */
+    inline void newSearch() { age.store((age.load(std::memory_order_relaxed) + 1) & 0x3F, std::memory_order_relaxed); }
+
+    /*
+     *   Look for the position in the table,
+     *   return true and fill data if the position is stored
+     */
+    bool probe(uint64_t key, TTData &data) const;
+
+    // store the search result of the position
+    void store(uint64_t key, Move move, int score, int depth, NodeType nodeType);
+
+    // return the permill of used entries of the current search generation
+    int hashfull() const;
+
+private:
+    std::unique_ptr<TTBucket[]> buckets;
+    std::size_t bucketCount;
+    std::atomic<uint8_t> age;
+
+    // maps the key to a bucket, multiplicative range reduction, avoids modulo
+    inline TTBucket &bucket(uint64_t key) const
+    {
+        return buckets[(static_cast<__uint128_t>(key) * bucketCount) >> 64];
+    }
+};
+
+// global transposition table shared by all the search threads
+extern TranspositionTable transpositionTable;
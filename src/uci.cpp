@@ -5,14 +5,18 @@
 
 #include "uci.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <sstream>
+#include <thread>
 
-constexpr auto StartFEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
-constexpr auto EnPassantFEN = "rnbqkb1r/2pp2pn/1p6/pP1PppPp/8/2N5/P1P1PP1P/R1BQKBNR w KQkq f6 0 8";
-constexpr auto PromotionFEN = "r3kb1r/pbpqn1P1/1pn4p/5Q2/2P5/2N5/PP1BN1pP/R3KB1R w KQkq - 2 13";
-constexpr auto KiwipeteFEN = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+#include "evaluation.hpp"
+#include "nnue.hpp"
+#include "nnueKernels.hpp"
+#include "perft.hpp"
+#include "transpositionTable.hpp"
 
 void Uci::loop()
 {
@@ -21,11 +25,17 @@ void Uci::loop()
 
     bool exit = false;
 
-    board.loadFen(KiwipeteFEN);
+    positionFen = KiwipeteFEN;
+    positionMoves.clear();
+    board.loadFen(positionFen);
 
     do
     {
-        std::getline(std::cin, line);
+        // end of input is handled as quit
+        if (!std::getline(std::cin, line))
+        {
+            line = "quit";
+        }
 
         // convert the input line into a stream of words
         std::istringstream iss(line);
@@ -47,9 +57,13 @@ void Uci::loop()
         {
             newgameCommandAction();
         }
+        else if (command == "setoption")
+        {
+            setOptionCommandAction(iss);
+        }
         else if (command == "go")
         {
-            goCommandAction();
+            goCommandAction(iss);
         }
         else if (command == "stop")
         {
@@ -61,12 +75,16 @@ void Uci::loop()
         }
         else if (command == "position")
         {
-            positionCommandAction();
+            positionCommandAction(iss);
         }
         else if (command == "d")
         {
             diagramCommandAction();
         }
+        else if (command == "perft")
+        {
+            perftCommandAction(iss);
+        }
         else if (command == "help")
         {
             helpCommandAction();
@@ -92,7 +110,12 @@ void Uci::loop()
 */
 void Uci::uciCommandAction()
 {
-    std::cout << "uciok" << std::endl;
+    std::cout << "option name Hash type spin default " << TT_DEFAULT_SIZE_MB
+              << " min " << TT_MIN_SIZE_MB << " max " << TT_MAX_SIZE_MB << "\n"
+              << "option name Threads type spin default " << MIN_THREADS
+              << " min " << MIN_THREADS << " max " << MAX_THREADS << "\n"
+              << "option name EvalFile type string default <empty>\n"
+              << "uciok" << std::endl;
 }
 
 /*
@@ -103,20 +126,179 @@ void Uci::uciCommandAction()
 */
 void Uci::isReadyCommandAction()
 {
-    std::cout << "readyok" << std::endl;
+    // one write for the whole line, the search thread may be printing at the same time
+    std::cout << "readyok\n" << std::flush;
+}
+
+// threads used to clear the transposition table, all the hardware threads and not only the search threads
+static int tableClearThreads()
+{
+    return static_cast<int>(std::max(1U, std::thread::hardware_concurrency()));
 }
 
+/*
+    the next search will be from a different game,
+    clear the transposition table using all the hardware threads
+*/
 void Uci::newgameCommandAction()
 {
-    std::cout << "Not implemented yet!" << std::endl;
+    // the table can not be cleared while the threads are using it
+    threadPool.stopSearch();
+    threadPool.waitForSearchFinished();
+
+    transpositionTable.clear(tableClearThreads());
+}
+
+/*
+    setoption name <id> [value <x>]
+    change the internal parameters of the engine
+*/
+void Uci::setOptionCommandAction(std::istringstream &iss)
+{
+    std::string token, name, value;
+
+    // the table and the threads can not be changed while searching
+    threadPool.stopSearch();
+    threadPool.waitForSearchFinished();
+
+    iss >> token; // "name"
+
+    // the name and the value can have spaces
+    while (iss >> token && token != "value")
+    {
+        name += name.empty() ? token : " " + token;
+    }
+
+    while (iss >> token)
+    {
+        value += value.empty() ? token : " " + token;
+    }
+
+    if (name == "Hash")
+    {
+        try
+        {
+            // signed, a negative value is rejected instead of wrapping around
+            const long long sizeMB = std::stoll(value);
+
+            if (sizeMB >= TT_MIN_SIZE_MB && sizeMB <= TT_MAX_SIZE_MB)
+                transpositionTable.resize(sizeMB, tableClearThreads());
+            else
+                std::cout << "Invalid Hash value: " << value << std::endl;
+        }
+        catch (const std::exception &)
+        {
+            std::cout << "Invalid Hash value: " << value << std::endl;
+        }
+    }
+    else if (name == "Threads")
+    {
+        try
+        {
+            threadPool.setThreads(std::stoi(value));
+        }
+        catch (const std::exception &)
+        {
+            std::cout << "Invalid Threads value: " << value << std::endl;
+        }
+    }
+    else if (name == "EvalFile")
+    {
+        // without a network the classical evaluation is used
+        if (value.empty() || value == "<empty>")
+        {
+            network.unload();
+        }
+        else if (network.load(value))
+        {
+            std::cout << "info string NNUE network " << value << " loaded, " << nnueKernels.name << " kernels" << std::endl;
+        }
+        else
+        {
+            std::cout << "info string Invalid NNUE network: " << value << ", using the classical evaluation" << std::endl;
+        }
+    }
+    else
+    {
+        std::cout << "Unknown option: " << name << std::endl;
+    }
 }
 
 /*
     start calculating on the current position
+
+    go perft <depth> is an alias of the perft command
 */
-void Uci::goCommandAction()
+void Uci::goCommandAction(std::istringstream &iss)
 {
-    std::cout << "Not implemented yet!" << std::endl;
+    std::string token;
+    SearchLimits limits;
+    bool infinite = false;
+
+    // go without limits searches until the stop command
+    limits.infinite = true;
+
+    while (iss >> token)
+    {
+        if (token == "perft")
+        {
+            perftCommandAction(iss);
+            return;
+        }
+        else if (token == "depth")
+        {
+            iss >> limits.depth;
+            limits.depth = std::clamp(limits.depth, 1, MAX_PLY - 1);
+            limits.infinite = false;
+        }
+        else if (token == "nodes")
+        {
+            iss >> limits.nodes;
+            limits.infinite = false;
+        }
+        else if (token == "movetime")
+        {
+            iss >> limits.movetime;
+            limits.infinite = false;
+        }
+        else if (token == "wtime")
+        {
+            iss >> limits.time[static_cast<int>(Color::WHITE)];
+            limits.infinite = false;
+        }
+        else if (token == "btime")
+        {
+            iss >> limits.time[static_cast<int>(Color::BLACK)];
+            limits.infinite = false;
+        }
+        else if (token == "winc")
+        {
+            iss >> limits.inc[static_cast<int>(Color::WHITE)];
+        }
+        else if (token == "binc")
+        {
+            iss >> limits.inc[static_cast<int>(Color::BLACK)];
+        }
+        else if (token == "movestogo")
+        {
+            iss >> limits.movestogo;
+        }
+        else if (token == "infinite")
+        {
+            infinite = true;
+        }
+    }
+
+    // go infinite ignores the other limits
+    if (infinite)
+    {
+        limits = SearchLimits();
+        limits.infinite = true;
+    }
+
+    // a previous search is stopped, then the new one runs on the pool threads without waiting for it
+    threadPool.stopSearch();
+    threadPool.startSearch(board, limits);
 }
 
 /*
@@ -124,21 +306,134 @@ void Uci::goCommandAction()
 */
 void Uci::stopCommandAction()
 {
-    std::cout << "Not implemented yet!" << std::endl;
+    // the search thread polls the flag and prints the best move
+    threadPool.stopSearch();
 }
 
+/*
+    print the terms of the static evaluation of the current position
+*/
 void Uci::evalCommandAction()
 {
-    std::cout << "Not implemented yet!" << std::endl;
+    std::cout << traceEvaluation(board);
+
+    if (network.isLoaded())
+    {
+        // the accumulators of all the plies are large, they are not allocated on the thread stack
+        auto accumulators = std::make_unique<AccumulatorStack>();
+        accumulators->reset();
+
+        const int score = accumulators->evaluate(board);
+
+        std::cout << "NNUE evaluation: " << (board.sideToMove == Color::WHITE ? score : -score) << " cp (white side)\n";
+    }
+
+    std::cout << std::flush;
 }
 
 /*
     position [fen <fenstring> | startpos ]  moves <move1> .... <movei>
     set up the position described in fenstring on the internal board
+
+    The GUIs send the whole game on every move, if the position is the last one
+    followed by new moves only the new moves are played. The moves are played on the
+    board so the previous positions of the game are kept for repetition detection.
 */
-void Uci::positionCommandAction()
+void Uci::positionCommandAction(std::istringstream &iss)
 {
-    std::cout << "Not implemented yet!" << std::endl;
+    std::string token, fen;
+    std::vector<std::string> newMoves;
+
+    iss >> token;
+
+    if (token == "startpos")
+    {
+        fen = StartFEN;
+        iss >> token; // "moves"
+    }
+    else if (token == "fen")
+    {
+        while (iss >> token && token != "moves")
+        {
+            fen += fen.empty() ? token : " " + token;
+        }
+    }
+    else
+    {
+        std::cout << "Usage: position [fen <fenstring> | startpos ] moves <move1> .... <movei>" << std::endl;
+        return;
+    }
+
+    while (iss >> token)
+    {
+        newMoves.push_back(token);
+    }
+
+    // the board can not change while the threads are searching it
+    threadPool.stopSearch();
+    threadPool.waitForSearchFinished();
+
+    const bool continuesLastPosition =
+        fen == positionFen && newMoves.size() >= positionMoves.size() &&
+        std::equal(positionMoves.begin(), positionMoves.end(), newMoves.begin());
+
+    std::size_t firstNewMove = positionMoves.size();
+
+    if (!continuesLastPosition)
+    {
+        // an invalid fen keeps the previous position
+        Board newBoard;
+        const FenError error = newBoard.loadFen(fen, true);
+
+        if (error != FenError::NONE)
+        {
+            std::cout << "Invalid fen: " << fenErrorToString(error) << std::endl;
+            return;
+        }
+
+        board = newBoard;
+        positionFen = fen;
+        positionMoves.clear();
+        firstNewMove = 0;
+    }
+
+    for (std::size_t i = firstNewMove; i < newMoves.size(); i++)
+    {
+        if (!playUciMove(newMoves[i]))
+        {
+            std::cout << "Illegal move: " << newMoves[i] << std::endl;
+            break;
+        }
+
+        positionMoves.push_back(newMoves[i]);
+    }
+}
+
+/*
+    Play the move in uci notation (e2e4, e7e8q) if it is legal in the position,
+    the string is matched against the legal moves so the move type is the generated one
+*/
+bool Uci::playUciMove(std::string_view uciMove)
+{
+    generateLegalMoves(moves, board);
+
+    for (int i = 0; i < moves.size(); i++)
+    {
+        if (moves.get(i).toString() == uciMove)
+        {
+            board.makeMove(moves.get(i));
+
+            // the undo stack keeps the game for repetition detection, the search needs room on top of it
+            if (board.historyPly > MAX_HISTORY_PLY - MAX_PLY)
+            {
+                board.trimHistory();
+            }
+
+            return true;
+        }
+    }
+
+    return false;
 }
 
 /*
@@ -155,6 +450,23 @@ void Uci::diagramCommandAction()
               << moves.toString() << std::endl;
 }
 
+/*
+    perft <depth>
+    count the leaf nodes of the legal move tree, printing the nodes of each root move
+*/
+void Uci::perftCommandAction(std::istringstream &iss)
+{
+    int depth = 0;
+
+    if (!(iss >> depth) || depth < 1)
+    {
+        std::cout << "Usage: perft <depth>, depth should be greater than 0" << std::endl;
+        return;
+    }
+
+    perftDivide(board, depth, std::cout);
+}
+
 void Uci::helpCommandAction()
 {
     std::cout << "Commands:\n"
@@ -169,12 +481,16 @@ void Uci::helpCommandAction()
                  "ucinewgame\n"
                  "\tStart of a new game.\n\n"
 
+                 "setoption name <id> [value <x>]\n"
+                 "\tChange an engine option. Options: Hash (transposition table size in MB), Threads, EvalFile (NNUE network file).\n\n"
+
                  "position [fen <fenstring> | startpos ] moves <move1> .... <movei>\n"
                  "\tSet up the position on the internal board.\n\n"
 
                  "go\n"
                  "\tStart calculating.\n"
-                 "\tOptional parameters: searchmoves, ponder, wtime, btime, winc, binc, movestogo, depth, nodes, mate, movetime, infinite.\n\n"
+                 "\tOptional parameters: wtime, btime, winc, binc, movestogo, depth, nodes, movetime, infinite.\n"
+                 "\tWithout parameters the search runs until the stop command.\n\n"
 
                  "stop\n"
                  "\tStop calculating.\n\n"
@@ -185,6 +501,12 @@ void Uci::helpCommandAction()
                  "d\n"
                  "\tDisplay the current position on the board.\n\n"
 
+                 "eval\n"
+                 "\tDisplay the terms of the static evaluation of the current position.\n\n"
+
+                 "perft <depth> | go perft <depth>\n"
+                 "\tCount the leaf nodes of the legal move tree, with the nodes of each root move.\n\n"
+
               << std::endl;
 }
 
@@ -193,10 +515,13 @@ void Uci::helpCommandAction()
 */
 void Uci::quitCommandAction()
 {
+    threadPool.stopSearch();
+    threadPool.waitForSearchFinished();
+
     std::cout << "goodbye" << std::endl;
 }
 
 void Uci::unknownCommandAction()
 {
-    std::cout << "Unknown command, type help for more information" << std::endl;
+    std::cout << "Unknown command, type help for more information\n" << std::flush;
 }
\ No newline at end of file
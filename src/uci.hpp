@@ -3,10 +3,19 @@
 /*
     Uci protocol specifications
     https://gist.github.com/DOBRO/2592c6dad754ba67e6dcaec8c90165bf#file-uci-protocol-specification-txt
+
+    The search runs on the threads of the pool, the input loop keeps reading
+    commands while searching so stop, isready and quit are answered at once.
 */
 
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include <board.hpp>
 #include <moveGenerator.hpp>
+#include <threadPool.hpp>
 
 
 class Uci
@@ -22,15 +31,23 @@ private:
 
     Board board;
     MoveList moves;
-    
+    ThreadPool threadPool;
+
+    // position of the last position command, the board is the fen with the moves played
+    std::string positionFen;
+    std::vector<std::string> positionMoves;
+
     void uciCommandAction();
     void isReadyCommandAction();
     void newgameCommandAction();
-    void goCommandAction();
+    void setOptionCommandAction(std::istringstream &iss);
+    void goCommandAction(std::istringstream &iss);
     void stopCommandAction();
     void evalCommandAction();
-    void positionCommandAction();
+    void positionCommandAction(std::istringstream &iss);
+    bool playUciMove(std::string_view uciMove);
     void diagramCommandAction();
+    void perftCommandAction(std::istringstream &iss);
     void helpCommandAction();
     void quitCommandAction();
     void unknownCommandAction();